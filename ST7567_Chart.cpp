@@ -0,0 +1,88 @@
+// Strip chart for ST7567_FB library
+// (C) 2020 by Pawel A. Hernik
+
+#include "ST7567_Chart.h"
+
+// ----------------------------------------------------------------
+ST7567_Chart::ST7567_Chart(ST7567_FB &_lcd, uint8_t _x, uint8_t _y, uint8_t _w, uint8_t _h, uint8_t *_hist, uint8_t _n)
+  : lcd(_lcd)
+{
+  x = _x; y = _y; w = _w; h = _h;
+  hist = _hist;
+  n = _n ? _n : 1;
+  step = w/n ? w/n : 1;
+  head = cnt = seq = 0;
+  minVal = 0; maxVal = 100;
+  style = CHART_FILLED;
+  dither = 8;
+}
+// ----------------------------------------------------------------
+void ST7567_Chart::clear()
+{
+  head = cnt = 0;
+  lcd.fillRect(x,y,w,h,0);
+}
+// ----------------------------------------------------------------
+// draws slot of sample (0 - newest), clipped to the slot
+void ST7567_Chart::drawSlot(uint8_t age)
+{
+  if(age>=cnt || age>=n) return;
+  uint8_t sx = x+w-(age+1)*step;  // slots are aligned to the right edge
+  uint8_t yb = y+h-1;
+  uint8_t y1 = yb-sample(age);
+  uint8_t y0 = age+1<cnt ? yb-sample(age+1) : y1;
+  byte pat[4];
+  memcpy(pat,lcd.pattern,4);
+  lcd.setDither(dither);
+  // pattern phase follows the sample, so shifted and newly drawn slots match
+  byte dp[4];
+  uint8_t ph = (seq-age)*step-sx;
+  for(uint8_t k=0; k<4; k++) dp[k] = lcd.pattern[(k+ph)&3];
+  memcpy(lcd.pattern,dp,4);
+  // slot clipping within the caller's clip rectangle, restored at the end
+  uint8_t cx0 = lcd.clipX0, cy0 = lcd.clipY0, cx1 = lcd.clipX1, cy1 = lcd.clipY1;
+  uint8_t sx0 = max(sx,cx0), sx1 = min(sx+step,(int)cx1);
+  uint8_t sy0 = max(y,cy0), sy1 = min(y+h,(int)cy1);
+  lcd.setClip(sx0,sy0,sx1>sx0 ? sx1-sx0 : 0,sy1>sy0 ? sy1-sy0 : 0);
+  switch(style) {
+    case CHART_BAR:
+      lcd.fillRectD(sx,y1,step,yb-y1+1,1);
+      lcd.drawLineHfast(sx,sx+step-1,y1,1);
+      break;
+    case CHART_FILLED:
+      for(uint8_t j=0; j<step; j++) lcd.drawLineVfastD(sx+j,y0+(y1-y0)*(j+1)/step,yb,1);
+      // fall through
+    case CHART_LINE:
+      lcd.drawLine(sx-1,y0,sx+step-1,y1,1);  // from the end of previous slot
+      break;
+  }
+  lcd.setClip(cx0,cy0,cx1-cx0,cy1-cy0);
+  memcpy(lcd.pattern,pat,4);
+}
+// ----------------------------------------------------------------
+void ST7567_Chart::add(int16_t v)
+{
+  if(v<minVal) v = minVal;
+  if(v>maxVal) v = maxVal;
+  uint8_t s = (long)(v-minVal)*(h-1)/(maxVal-minVal);
+  head = (head+1)%(n+1);
+  hist[head] = s;
+  if(cnt<=n) cnt++;
+  seq++;
+  lcd.scrollRegion(x,y,w,h,-step,0);
+  if(w>n*step) lcd.fillRect(x,y,w-n*step,h,0);  // columns left of the oldest slot
+  drawSlot(0);
+}
+// ----------------------------------------------------------------
+void ST7567_Chart::redraw()
+{
+  lcd.fillRect(x,y,w,h,0);
+  for(uint8_t i=0; i<cnt; i++) drawSlot(i);
+}
+// ----------------------------------------------------------------
+void ST7567_Chart::flush()
+{
+  uint8_t y8s = y/8;
+  lcd.copy(x,y8s,w,(y+h-1)/8-y8s+1);
+}
+// ----------------------------------------------------------------
@@ -0,0 +1,51 @@
+// Strip chart for ST7567_FB library
+// (C) 2020 by Pawel A. Hernik
+
+/*
+ Chart keeps history of samples in ring buffer supplied by the caller, n+1 bytes for n visible samples
+ (the extra one is needed to draw the line to the oldest sample).
+ New sample shifts chart area left by one slot with scrollRegion() (memmove of page rows), only the new slot is drawn
+ and flush() sends only pages of the chart rectangle. Many charts can be used on one screen.
+ Styles:
+  CHART_BAR    - dithered bars with solid top
+  CHART_LINE   - line connecting samples
+  CHART_FILLED - line with dithered area below
+ Works on frame buffer directly, not in page mode.
+*/
+
+#ifndef _ST7567_CHART_H
+#define _ST7567_CHART_H
+
+#include "ST7567_FB.h"
+
+#define CHART_BAR    0
+#define CHART_LINE   1
+#define CHART_FILLED 2
+
+// ---------------------------------
+class ST7567_Chart {
+public:
+  // width of sample slot is w/n columns, hist has n+1 bytes
+  ST7567_Chart(ST7567_FB &_lcd, uint8_t _x, uint8_t _y, uint8_t _w, uint8_t _h, uint8_t *_hist, uint8_t _n);
+  void setRange(int16_t lo, int16_t hi) { minVal = lo; maxVal = hi>lo ? hi : lo+1; }
+  void setStyle(uint8_t _style, int8_t _dither=8) { style = _style; dither = _dither; }
+  void add(int16_t v);
+  void redraw();     // slots are drawn within current clip rectangle, which is kept
+  void clear();
+  void flush();
+  uint8_t sample(uint8_t age) { return hist[(head+n+1-age)%(n+1)]; }  // 0 - newest
+
+  ST7567_FB &lcd;
+  uint8_t x, y, w, h;
+  uint8_t *hist;     // scaled samples, 0..h-1
+  uint8_t n, head, cnt, step;  // head - newest sample, cnt - valid samples (up to n+1)
+  uint8_t seq;       // number of added samples, keeps dither pattern attached to samples when shifted
+  int16_t minVal, maxVal;
+  uint8_t style;
+  int8_t dither;
+
+protected:
+  void drawSlot(uint8_t age);
+};
+
+#endif
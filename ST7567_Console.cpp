@@ -0,0 +1,82 @@
+// Hardware scrolled text console for ST7567_FB library
+// (C) 2020 by Pawel A. Hernik
+
+#include "ST7567_Console.h"
+
+// ----------------------------------------------------------------
+void ST7567_Console::begin(const uint8_t *font, uint8_t _lineHt)
+{
+  lcd.setFont(font);
+  lineHt = _lineHt ? _lineHt : (lcd.fontHeight()+7)/8*8;
+  if(lineHt>lcd.scrHtPx) lineHt = lcd.scrHtPx;
+  clear();
+}
+// ----------------------------------------------------------------
+void ST7567_Console::clear()
+{
+  lcd.cls();
+  lcd.display();
+  lcd.setScroll(0);
+  top = cy = 0;
+  cx = 0;
+  pendingNL = false;
+}
+// ----------------------------------------------------------------
+// next line is cleared in frame buffer only, window is moved when it gets below the last row
+void ST7567_Console::newLine()
+{
+  uint8_t ht = lcd.scrHtPx;
+  cx = 0;
+  pendingNL = false;
+  if(lcd.rotation&1) { // start line scrolls along logical x in portrait, so text is moved in frame buffer
+    if(cy+2*lineHt>ht) lcd.scrollRegion(0,0,lcd.scrWd,ht,0,-lineHt); else cy += lineHt;
+    lcd.fillRect(0,cy,lcd.scrWd,lineHt,0);
+    return;
+  }
+  int16_t bottom = (cy-top+ht) % ht + 2*lineHt;  // screen row below new line
+  if(bottom>ht) top = (top+bottom-ht) % ht;
+  cy = (cy+lineHt) % ht;
+  uint8_t h = lineHt;
+  if(cy+h>ht) {
+    lcd.fillRect(0,0,lcd.scrWd,cy+h-ht,0);
+    h = ht-cy;
+  }
+  lcd.fillRect(0,cy,lcd.scrWd,h,0);
+}
+// ----------------------------------------------------------------
+void ST7567_Console::putChar(uint8_t c)
+{
+  if(c=='\r') return;
+  if(c=='\n') {
+    if(pendingNL) newLine();
+    pendingNL = true;
+    return;
+  }
+  if(pendingNL) newLine();
+  int wd = lcd.charWidth(c);
+  if(cx+wd>lcd.scrWd && cx>0) newLine();
+  lcd.printChar(cx,cy,c);
+  if(cy+lineHt>lcd.scrHtPx) lcd.printChar(cx,cy-lcd.scrHtPx,c);  // part of the line at the start of the ring
+  cx += wd;
+}
+// ----------------------------------------------------------------
+void ST7567_Console::flush()
+{
+  lcd.displayDirty();
+  lcd.setScroll(top);
+}
+// ----------------------------------------------------------------
+size_t ST7567_Console::write(uint8_t c)
+{
+  putChar(c);
+  flush();
+  return 1;
+}
+// ----------------------------------------------------------------
+size_t ST7567_Console::write(const uint8_t *buf, size_t n)
+{
+  for(size_t i=0; i<n; i++) putChar(buf[i]);
+  flush();
+  return n;
+}
+// ----------------------------------------------------------------
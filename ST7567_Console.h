@@ -0,0 +1,39 @@
+// Hardware scrolled text console for ST7567_FB library
+// (C) 2020 by Pawel A. Hernik
+
+/*
+ Display RAM is used as a ring buffer of text lines and the start line register moves the visible window,
+ so a new line costs only its own pages (128 bytes for 8 pixel lines) instead of sending the whole frame.
+ Frame buffer keeps RAM order, lines crossing the end of the ring are drawn in 2 parts.
+ Works with proportional fonts in rotations 0 and 2, derived from Print so print()/println() of numbers work.
+ In portrait (rotation 1 and 3) the start line would move text sideways, so there the console falls back
+ to scrollRegion() in frame buffer and each new line sends the whole screen.
+ Other drawing on the same display object doesn't follow the scrolling.
+*/
+
+#ifndef _ST7567_CONSOLE_H
+#define _ST7567_CONSOLE_H
+
+#include "ST7567_FB.h"
+
+// ---------------------------------
+class ST7567_Console : public Print {
+public:
+  ST7567_Console(ST7567_FB &_lcd) : lcd(_lcd) { lineHt = 8; }
+  void begin(const uint8_t *font, uint8_t _lineHt=0);  // line height 0 - font height rounded up to full pages
+  void clear();
+  void putChar(uint8_t c);  // without sending to LCD
+  void newLine();
+  void flush();             // sends changed part of current line and moves start line
+  size_t write(uint8_t c);
+  size_t write(const uint8_t *buf, size_t n);
+
+  ST7567_FB &lcd;
+  uint8_t lineHt;
+  uint8_t top;        // RAM line shown in first row of the screen
+  uint8_t cy;         // RAM line of current text line
+  int16_t cx;
+  bool pendingNL;     // new line is started with the next character, so println() doesn't scroll empty line
+};
+
+#endif
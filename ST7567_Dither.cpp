@@ -0,0 +1,115 @@
+// Greyscale image conversion for ST7567_FB library
+// (C) 2020 by Pawel A. Hernik
+
+#include "ST7567_Dither.h"
+
+// 8x8 Bayer matrix, thresholds 2..254
+static const uint8_t bayer8[64] PROGMEM = {
+    2,130, 34,162, 10,138, 42,170,
+  194, 66,226, 98,202, 74,234,106,
+   50,178, 18,146, 58,186, 26,154,
+  242,114,210, 82,250,122,218, 90,
+   14,142, 46,174,  6,134, 38,166,
+  206, 78,238,110,198, 70,230,102,
+   62,190, 30,158, 54,182, 22,150,
+  254,126,222, 94,246,118,214, 86
+};
+// ----------------------------------------------------------------
+ST7567_Dither::ST7567_Dither(ST7567_FB &_lcd, int16_t *_err)
+  : lcd(_lcd)
+{
+  err = _err;
+  matrix = NULL;
+  kernel = err ? DITHER_FS : DITHER_ORDERED;
+  x = y = w = 0;
+}
+// ----------------------------------------------------------------
+void ST7567_Dither::begin(int16_t _x, int16_t _y, uint8_t _w)
+{
+  x = _x; y = _y; w = _w;
+  if(kernel>=DITHER_FS && !err) kernel = DITHER_ORDERED;
+  if(kernel<DITHER_FS) return;
+  uint8_t rows = kernel==DITHER_FS ? 2 : 3;
+  e0 = err; e1 = e0+w+4; e2 = e1+w+4;
+  memset(err,0,rows*(w+4)*sizeof(int16_t));
+}
+// ----------------------------------------------------------------
+// error rows have 1 entry before and 3 after the row
+void ST7567_Dither::putRow(const uint8_t *row, bool progmem)
+{
+#ifdef USE_PAGE_MODE
+  if(lcd.dlMode) return;
+#endif
+  // visible pixels i0..i1-1
+  int16_t i0 = lcd.clipX0-x, i1 = lcd.clipX1-x;
+  if(i0<0) i0 = 0;
+  if(i1>w) i1 = w;
+  if(y<lcd.clipY0 || y>=lcd.clipY1) i1 = 0;
+  byte *d = i0<i1 ? lcd.scr+(y/8)*lcd.scrWd+x : NULL;
+  byte bit = 1<<(y&7);
+  uint8_t i;
+  switch(kernel) {
+    case DITHER_THRESHOLD:
+    case DITHER_ORDERED: {
+      const uint8_t *m = (matrix ? matrix : bayer8)+(y&7)*8;
+      for(i=i0; i<i1; i++) {
+        uint8_t v = progmem ? pgm_read_byte(row+i) : row[i];
+        uint8_t t = kernel==DITHER_THRESHOLD ? 127 : pgm_read_byte(m+((x+i)&7));
+        if(v>t) d[i] |= bit; else d[i] &= ~bit;
+      }
+      break;
+    }
+    case DITHER_FS:
+      for(i=0; i<w; i++) {
+        int16_t v = (progmem ? pgm_read_byte(row+i) : row[i])+e0[i+1];
+        int16_t q = v;
+        if(v>127) q -= 255;
+        if(d && i>=i0 && i<i1) { if(v>127) d[i] |= bit; else d[i] &= ~bit; }
+        int16_t q7 = q*7/16, q3 = q*3/16, q5 = q*5/16;
+        e0[i+2] += q7;
+        e1[i]   += q3;
+        e1[i+1] += q5;
+        e1[i+2] += q-q7-q3-q5;
+      }
+      { int16_t *t = e0; e0 = e1; e1 = t; }
+      memset(e1,0,(w+4)*sizeof(int16_t));
+      break;
+    case DITHER_ATKINSON:
+      for(i=0; i<w; i++) {
+        int16_t v = (progmem ? pgm_read_byte(row+i) : row[i])+e0[i+1];
+        int16_t q = v;
+        if(v>127) q -= 255;
+        if(d && i>=i0 && i<i1) { if(v>127) d[i] |= bit; else d[i] &= ~bit; }
+        q /= 8;
+        e0[i+2] += q; e0[i+3] += q;
+        e1[i] += q; e1[i+1] += q; e1[i+2] += q;
+        e2[i+1] += q;
+      }
+      { int16_t *t = e0; e0 = e1; e1 = e2; e2 = t; }
+      memset(e2,0,(w+4)*sizeof(int16_t));
+      break;
+  }
+  if(d) lcd.markDirty(x+i0,x+i1-1,y/8,y/8);
+  y++;
+}
+// ----------------------------------------------------------------
+void ST7567_Dither::drawImage(const uint8_t *img, int16_t x, int16_t y)
+{
+  uint8_t wd = pgm_read_byte(img+0), ht = pgm_read_byte(img+1);
+  begin(x,y,wd);
+  for(uint8_t r=0; r<ht; r++) putRow(img+2+r*wd,true);
+}
+// ----------------------------------------------------------------
+// horizontal (left to right) or vertical (top to bottom) gradient, w up to SCR_WD
+void ST7567_Dither::drawGradient(int16_t x, int16_t y, uint8_t w, uint8_t h, uint8_t v0, uint8_t v1, bool vertical)
+{
+  uint8_t row[SCR_WD];
+  if(w>SCR_WD) w = SCR_WD;
+  begin(x,y,w);
+  if(!vertical) for(uint8_t i=0; i<w; i++) row[i] = v0+(int16_t)(v1-v0)*i/(w>1 ? w-1 : 1);
+  for(uint8_t r=0; r<h; r++) {
+    if(vertical) memset(row,v0+(int16_t)(v1-v0)*r/(h>1 ? h-1 : 1),w);
+    putRow(row);
+  }
+}
+// ----------------------------------------------------------------
@@ -0,0 +1,46 @@
+// Greyscale image conversion for ST7567_FB library
+// (C) 2020 by Pawel A. Hernik
+
+/*
+ 8-bit grey pixels (0 - clear, 255 - all pixels set) are converted row by row directly into frame buffer,
+ so images can be streamed from PROGMEM, SD card or serial port without buffering more than one row.
+ Kernels:
+  DITHER_THRESHOLD - value>=128
+  DITHER_ORDERED   - 8x8 threshold matrix, Bayer by default or own one set by setMatrix()
+  DITHER_FS        - Floyd-Steinberg error diffusion, err buffer needs 2*(w+4) entries
+  DITHER_ATKINSON  - Atkinson error diffusion (3/4 of error, more contrast), err buffer needs 3*(w+4) entries
+ Error diffusion is independent of clipping, hidden pixels are calculated too.
+ Works on frame buffer only, not in page mode.
+*/
+
+#ifndef _ST7567_DITHER_H
+#define _ST7567_DITHER_H
+
+#include "ST7567_FB.h"
+
+#define DITHER_THRESHOLD 0
+#define DITHER_ORDERED   1
+#define DITHER_FS        2
+#define DITHER_ATKINSON  3
+
+// ---------------------------------
+class ST7567_Dither {
+public:
+  ST7567_Dither(ST7567_FB &_lcd, int16_t *_err=NULL);
+  void setKernel(uint8_t k) { kernel = k; }
+  void setMatrix(const uint8_t *m) { matrix = m; }  // 64 thresholds 0..254 in PROGMEM, row by row, NULL - Bayer
+  void begin(int16_t _x, int16_t _y, uint8_t _w);
+  void putRow(const uint8_t *row, bool progmem=false);  // next row of w pixels
+  void drawImage(const uint8_t *img, int16_t x, int16_t y);  // PROGMEM, width and height in first 2 bytes
+  void drawGradient(int16_t x, int16_t y, uint8_t w, uint8_t h, uint8_t v0, uint8_t v1, bool vertical=false);
+
+  ST7567_FB &lcd;
+  int16_t *err;         // error rows, rotated after each row
+  int16_t *e0, *e1, *e2;
+  const uint8_t *matrix;
+  int16_t x, y;         // position of next row
+  uint8_t w;
+  uint8_t kernel;
+};
+
+#endif
@@ -0,0 +1,78 @@
+// ST7567 controller model for ST7567_FB library
+// (C) 2020 by Pawel A. Hernik
+
+#include "ST7567_Emu.h"
+
+// ----------------------------------------------------------------
+void ST7567_Emu::reset()
+{
+  memset(ram,0,sizeof(ram));
+  page = col = rmwCol = startLine = 0;
+  argCmd = 0;
+  contrast = 0x20;
+  cs = cmd = rmw = false;
+  segRemap = comRemap = invert = allOn = displayOn = false;
+}
+// ----------------------------------------------------------------
+void ST7567_Emu::write(uint8_t v)
+{
+  if(next) next->write(v);
+  if(!cs) return;  // chip not selected
+  if(cmd) { command(v); return; }
+  if(page<EMU_RAM_HT8 && col<EMU_RAM_WD) ram[page][col] = v;
+  if(col<EMU_RAM_WD) col++;  // column counter increments on write also in RMW mode
+}
+// ----------------------------------------------------------------
+void ST7567_Emu::command(uint8_t c)
+{
+  if(argCmd) { // argument of 2-byte command
+    if(argCmd==0x81) contrast = c & 0x3f;
+    argCmd = 0;
+    return;
+  }
+  if(c<0x10)       col = (col & 0xf0) | (c & 0x0f);         // column address LSB
+  else if(c<0x20)  col = (col & 0x0f) | ((c & 0x0f) << 4);  // column address MSB
+  else if(c<0x40)  ;                                         // resistor ratio, power control
+  else if(c<0x80)  startLine = c & 0x3f;
+  else if(c>=0xb0 && c<=0xbf) page = c & 0x0f;
+  else if(c>=0xc0 && c<=0xcf) comRemap = (c & 0x08)!=0;
+  else switch(c) {
+    case 0x81: case 0xac: case 0xad: case 0xf8: argCmd = c; break;  // contrast, static indicator, booster
+    case 0xa0: segRemap = false; break;
+    case 0xa1: segRemap = true; break;
+    case 0xa4: allOn = false; break;
+    case 0xa5: allOn = true; break;
+    case 0xa6: invert = false; break;
+    case 0xa7: invert = true; break;
+    case 0xae: displayOn = false; break;
+    case 0xaf: displayOn = true; break;
+    case 0xe0: rmw = true; rmwCol = col; break;
+    case 0xee: if(rmw) col = rmwCol; rmw = false; break;
+    case 0xe2: { ST7567_Transport *n = next; bool s = cs; reset(); next = n; cs = s; cmd = true; } break;
+    default: break;  // bias, NOP, test
+  }
+}
+// ----------------------------------------------------------------
+// glass top row is COM63, SEG0 is the leftmost column (module wiring)
+bool ST7567_Emu::glassPixel(uint8_t x, uint8_t y)
+{
+  if(!displayOn) return false;
+  if(allOn) return true;
+  uint8_t com = EMU_GLASS_HT-1-y;
+  uint8_t scan = comRemap ? EMU_GLASS_HT-1-com : com;
+  uint8_t line = (scan+startLine) & 0x3f;
+  uint8_t c = segRemap ? EMU_RAM_WD-1-x : x;
+  bool pix = (ram[line/8][c] >> (line&7)) & 1;
+  return invert ? !pix : pix;
+}
+// ----------------------------------------------------------------
+// plain PBM, can be converted to PNG by any image tool
+void ST7567_Emu::dumpPBM(Print &out)
+{
+  out.print("P1\n128 64\n");
+  for(int y=0; y<EMU_GLASS_HT; y++) {
+    for(int x=0; x<EMU_GLASS_WD; x++) out.print(glassPixel(x,y) ? '1' : '0');
+    out.print('\n');
+  }
+}
+// ----------------------------------------------------------------
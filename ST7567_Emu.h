@@ -0,0 +1,44 @@
+// ST7567 controller model for ST7567_FB library
+// (C) 2020 by Pawel A. Hernik
+
+/*
+ ST7567_Emu is a transport backend which interprets the byte stream like ST7567 does:
+ page/column addressing, RMW/END, start line, SEG/COM remap, invert, all pixels on, display on/off.
+ It keeps full 132x65 display RAM and can dump what the glass shows as PBM image,
+ so the output can be checked without hardware or compared with reference images.
+*/
+
+#ifndef _ST7567_EMU_H
+#define _ST7567_EMU_H
+
+#include "ST7567_Transport.h"
+
+#define EMU_RAM_WD   132
+#define EMU_RAM_HT8  9  // 65 lines, last page has only 1 line
+#define EMU_GLASS_WD 128
+#define EMU_GLASS_HT 64
+
+// ---------------------------------
+class ST7567_Emu : public ST7567_Transport {
+public:
+  ST7567_Emu(ST7567_Transport *_next=NULL) { next = _next; reset(); }
+  void begin() { if(next) next->begin(); }
+  void csActive() { cs = true; if(next) next->csActive(); }
+  void csIdle() { cs = false; if(next) next->csIdle(); }
+  void dcCommand() { cmd = true; if(next) next->dcCommand(); }
+  void dcData() { cmd = false; if(next) next->dcData(); }
+  void write(uint8_t v);
+  void reset();
+  void command(uint8_t c);
+  bool glassPixel(uint8_t x, uint8_t y);
+  void dumpPBM(Print &out);
+
+  ST7567_Transport *next;
+  uint8_t ram[EMU_RAM_HT8][EMU_RAM_WD];
+  uint8_t page, col, rmwCol, startLine;
+  uint8_t argCmd;  // first byte of 2-byte command waiting for argument
+  uint8_t contrast;
+  bool cs, cmd, rmw, segRemap, comRemap, invert, allOn, displayOn;
+};
+
+#endif
@@ -15,15 +15,73 @@
 */
 
 #include "ST7567_FB.h"
+#ifdef USE_PAGE_MODE
+#include <stdarg.h>
+#endif
 
 #define fontbyte(x) pgm_read_byte(&cfont.font[x])
 
-#include <SPI.h>
+#ifdef USE_PAGE_MODE
+#define DL_OFF  0
+#define DL_PLAY 1  // list is replayed into band
+#define DL_REC  2  // drawing calls are recorded
+#define DL_SKIP 3  // text is measured while recording, nothing is drawn or recorded
+
+// display list opcodes
+enum { OP_CLIP=1, OP_PIXEL, OP_LINE, OP_LINED, OP_LINEH, OP_LINEV, OP_LINEHF, OP_LINEHFD, OP_LINEVF, OP_LINEVFD,
+       OP_RECT, OP_RECTD, OP_FILL, OP_FILLD, OP_CIRCLE, OP_FCIRCLE, OP_FCIRCLED, OP_FTRI, OP_FTRID, OP_FPOLY, OP_FPOLYD,
+       OP_BLIT, OP_BLITRLE, OP_CHAR, OP_STR };
 
-#define CS_IDLE     digitalWrite(csPin, HIGH)
-#define CS_ACTIVE   digitalWrite(csPin, LOW)
-#define DC_DATA     digitalWrite(dcPin, HIGH)
-#define DC_COMMAND  digitalWrite(dcPin, LOW)
+// in page mode drawing call is added to the list instead of being executed
+#define PAGE_REC(op,fmt,...) if(dlMode>=DL_REC) { if(dlMode==DL_REC) dlPut(op,fmt,__VA_ARGS__); return; }
+#else
+#define PAGE_REC(op,fmt,...)
+#endif
+
+#ifdef USE_STATS
+// counts top level drawing call, bytes marked by markDirty() go to its primitive
+struct StatCall {
+  ST7567_Stats &s;
+  bool top;
+  StatCall(ST7567_FB *lcd, uint8_t p) : s(lcd->stats) {
+    top = s.cur==STAT_PRIMS;
+#ifdef USE_PAGE_MODE
+    if(lcd->dlMode==DL_PLAY) top = false;  // already counted when recorded
+#endif
+    if(top) { s.cur = p; s.calls[p]++; }
+  }
+  ~StatCall() { if(top) s.cur = STAT_PRIMS; }
+};
+
+// measures time of outermost flush function
+struct StatFlush {
+  ST7567_Stats &s;
+  uint32_t t;
+  bool top;
+  StatFlush(ST7567_FB *lcd) : s(lcd->stats) { top = !s.flushing; s.flushing = true; t = micros(); }
+  ~StatFlush() {
+    if(!top) return;
+    t = micros()-t;
+    s.flushing = false;
+    s.flushes++;
+    s.flushUs = t;
+    s.flushUsSum += t;
+    if(t>s.flushUsMax) s.flushUsMax = t;
+  }
+};
+#define STAT_CALL(p)   StatCall _stat(this,p)
+#define STAT_FLUSH     StatFlush _stat(this)
+#define STAT_ADD(f,n)  stats.f += n
+#else
+#define STAT_CALL(p)
+#define STAT_FLUSH
+#define STAT_ADD(f,n)
+#endif
+
+#define CS_IDLE     bus->csIdle()
+#define CS_ACTIVE   bus->csActive()
+#define DC_DATA     bus->dcData()
+#define DC_COMMAND  bus->dcCommand()
 
 //------------------------------
 // ST7567 Commands
@@ -82,25 +140,30 @@ const uint8_t initData[] PROGMEM = {
 // ----------------------------------------------------------------
 inline void ST7567_FB::sendSPI(uint8_t v)
 {
-  #ifdef USE_HW_SPI
-  SPI.transfer(v);
-  #else
-  shiftOut(sdiPin, clkPin, MSBFIRST, v);
-  #endif
+  bus->write(v);
 }
 // ----------------------------------------------------------------
 inline void ST7567_FB::sendCmd(uint8_t cmd)
 {
   DC_COMMAND;
   sendSPI(cmd);
+  STAT_ADD(cmdBytes,1);
 }
 // ----------------------------------------------------------------
 inline void ST7567_FB::sendData(uint8_t data)
 {
   DC_DATA;
   sendSPI(data);
+  STAT_ADD(dataBytes,1);
 }
 // ----------------------------------------------------------------
+// default backend is created only by pin based constructors, objects with own transport don't pay for it
+#ifdef USE_HW_SPI
+#define DEF_BUS(dc,cs,sdi,clk) new ST7567_HWSPI(dc,cs)
+#else
+#define DEF_BUS(dc,cs,sdi,clk) new ST7567_SWSPI(dc,cs,sdi,clk)
+#endif
+
 ST7567_FB::ST7567_FB(uint8_t dc, uint8_t rst, uint8_t cs)
 {
   dcPin   = dc;
@@ -108,6 +171,7 @@ ST7567_FB::ST7567_FB(uint8_t dc, uint8_t rst, uint8_t cs)
   csPin   = cs;
   sdiPin  = 11;
   clkPin  = 13;
+  bus     = defBus = DEF_BUS(dc,cs,11,13);
 }
 // ----------------------------------------------------------------
 ST7567_FB::ST7567_FB(uint8_t dc, uint8_t rst, uint8_t cs, uint8_t sdi, uint8_t clk)
@@ -117,21 +181,61 @@ ST7567_FB::ST7567_FB(uint8_t dc, uint8_t rst, uint8_t cs, uint8_t sdi, uint8_t c
   csPin   = cs;
   sdiPin  = sdi;
   clkPin  = clk;
+  bus     = defBus = DEF_BUS(dc,cs,sdi,clk);
+}
+// ----------------------------------------------------------------
+// any backend: bulk hardware SPI, fast software SPI, recorder for measurements
+ST7567_FB::ST7567_FB(ST7567_Transport *t, uint8_t rst)
+{
+  dcPin   = csPin = 255;
+  rstPin  = rst;
+  sdiPin  = clkPin = 255;
+  bus     = t;
 }
 // ----------------------------------------------------------------
-byte ST7567_FB::scr[SCR_WD*SCR_HT8];
+// default buffers, used by all instances unless setBuffer() is called
+#ifdef USE_STATIC_BUF
+byte ST7567_FB::fbuf[SCR_WD*SCR_HT8];
+#endif
+#ifdef USE_SHADOW_BUF
+byte ST7567_FB::shadowBuf[SCR_WD*SCR_HT8];
+#endif
+
+// for other panel sizes or 2nd display, buf must have wd*((ht+7)/8) bytes, ht up to 64 (128 in portrait)
+void ST7567_FB::setBuffer(byte *buf, uint8_t wd, uint8_t ht, byte *shadowBuf)
+{
+  scr = buf;
+  scrWd = wd;
+  scrHtPx = ht;
+  scrHt = (ht+7)/8;
+  resetClip();
+#ifdef USE_SHADOW_BUF
+  if(shadowBuf) shadow = shadowBuf;
+  shadowValid = false;
+#endif
+  setDirty();
+}
 
 void ST7567_FB::init(int contrast)
 {
-  scrWd=SCR_WD;
-  scrHt=SCR_HT/8;
   isNumberFun = &isNumber;
   cr = 0;
   cfont.font = NULL;
+#ifdef USE_STATS
+  resetStats();
+#endif
   dualChar = 0;
+  opaque = 0;
+#ifdef USE_FONT_CACHE
+  for(uint8_t i=0; i<FONT_CACHE_GLYPHS; i++) fontCache[i].font = NULL;
+  cacheTick = 0;
+#endif
+
+#ifdef USE_SHADOW_BUF
+  shadowValid = false;
+  bytesSaved = 0;
+#endif
 
-  pinMode(csPin, OUTPUT);
-  pinMode(dcPin, OUTPUT);
   if(rstPin<255) {
     pinMode(rstPin, OUTPUT);
     digitalWrite(rstPin, HIGH);
@@ -142,25 +246,17 @@ void ST7567_FB::init(int contrast)
     delay(10);
   }
 
-#ifdef USE_HW_SPI
-  SPI.begin();
-  SPI.setDataMode(SPI_MODE0);
-#ifdef __AVR__
-  SPI.setClockDivider(SPI_CLOCK_DIV2);
-#endif
-#else
-  pinMode(sdiPin, OUTPUT);
-  pinMode(clkPin, OUTPUT);
-#endif
+  bus->begin();
   initCmds();
   setContrast(contrast);
+  setDirty();
   //setRotation(0);
 }
 // ----------------------------------------------------------------
 void ST7567_FB::initCmds()
 {
-  CS_ACTIVE;
-  for(int i=0; i<sizeof(initData); i++) sendCmd(pgm_read_byte(initData+i));
+  for(int i=0; i<sizeof(initData); i++) queueCmd(pgm_read_byte(initData+i));
+  sendCmds();
   /*
   sendCmd(ST7567_BIAS_7);
   sendCmd(ST7567_SEG_NORMAL);
@@ -185,14 +281,75 @@ void ST7567_FB::initCmds()
   CS_IDLE;
 }
 // ----------------------------------------------------------------
-void ST7567_FB::gotoXY(byte x, byte y)
+void ST7567_FB::sendCmds()
 {
+  if(!cmdLen) return;
   CS_ACTIVE;
-  sendCmd(ST7567_PAGE_ADDR | y);
-  sendCmd(ST7567_COL_ADDR_H | (x >> 4));
-  sendCmd(ST7567_COL_ADDR_L | (x & 0xf));
-  sendCmd(ST7567_RMW);
-  //CS_IDLE;
+  bus->writeCommands(cmdBuf,cmdLen);
+  STAT_ADD(csCnt,1);
+  STAT_ADD(cmdBytes,cmdLen);
+  cmdLen = 0;
+  while(bus->busy());  // cmdBuf is filled again at once, commands are short
+}
+// ----------------------------------------------------------------
+// CS is left active, data can follow
+void ST7567_FB::gotoXY(byte x, byte y)
+{
+  queueCmd(ST7567_PAGE_ADDR | y);
+  queueCmd(ST7567_COL_ADDR_H | (x >> 4));
+  queueCmd(ST7567_COL_ADDR_L | (x & 0xf));
+  queueCmd(ST7567_RMW);
+  sendCmds();
+}
+// ----------------------------------------------------------------
+// x without xOfs(), x and y8 are logical in portrait
+void ST7567_FB::writePage(uint8_t x, uint8_t y8, const byte *buf, uint8_t n)
+{
+  if(rotation&1) { writeTiles(buf-x-y8*scrWd,x,x+n-1,y8,y8); return; }
+  gotoXY(x+xOfs(),y8);
+  bus->writeData(buf,n);
+  CS_IDLE;
+  STAT_ADD(dataBytes,n);
+}
+// ----------------------------------------------------------------
+// whole frame in frame buffer layout, used also for grey planes
+void ST7567_FB::writeFrame(const byte *buf)
+{
+  if(rotation&1) { writeTiles(buf,0,scrWd-1,0,scrHt-1); return; }
+  for(uint8_t y8=0; y8<scrHt; y8++) writePage(0,y8,buf+y8*scrWd,scrWd);
+}
+// ----------------------------------------------------------------
+// portrait: logical columns lx0..lx1 of pages lp0..lp1 are LCD pages lx0/8..lx1/8, columns lp0*8..lp1*8+7,
+// so each 8x8 tile is transposed, LCD page gets one CS window with all its tiles
+// tiles go through 2 buffers in turn, asynchronous backend still reads one while the other is filled
+void ST7567_FB::writeTiles(const byte *buf, uint8_t lx0, uint8_t lx1, uint8_t lp0, uint8_t lp1)
+{
+  for(uint8_t p=lx0/8; p<=lx1/8; p++) {
+    gotoXY(lp0*8+xOfs(),p);
+    DC_DATA;
+    for(uint8_t lp=lp0; lp<=lp1; lp++) {
+      byte *t = tileBuf[tileIdx ^= 1];
+      transpose8(buf+lp*scrWd+p*8,t);
+      bus->write(t,8);
+    }
+    CS_IDLE;
+    STAT_ADD(dataBytes,(lp1-lp0+1)*8);
+  }
+}
+// ----------------------------------------------------------------
+// out[j] bit i = in[i] bit j, 3 steps of swapping 1x1, 2x2 and 4x4 blocks in two 32-bit words
+void ST7567_FB::transpose8(const byte *in, byte *out)
+{
+  uint32_t x = in[0] | (uint32_t)in[1]<<8 | (uint32_t)in[2]<<16 | (uint32_t)in[3]<<24;
+  uint32_t y = in[4] | (uint32_t)in[5]<<8 | (uint32_t)in[6]<<16 | (uint32_t)in[7]<<24;
+  uint32_t t;
+  t = (x ^ (x>>7)) & 0x00aa00aa;  x ^= t ^ (t<<7);
+  t = (y ^ (y>>7)) & 0x00aa00aa;  y ^= t ^ (t<<7);
+  t = (x ^ (x>>14)) & 0x0000cccc; x ^= t ^ (t<<14);
+  t = (y ^ (y>>14)) & 0x0000cccc; y ^= t ^ (t<<14);
+  t = ((x>>4) ^ y) & 0x0f0f0f0f;  y ^= t; x ^= t<<4;
+  out[0] = x; out[1] = x>>8; out[2] = x>>16; out[3] = x>>24;
+  out[4] = y; out[5] = y>>8; out[6] = y>>16; out[7] = y>>24;
 }
 // ----------------------------------------------------------------
 void ST7567_FB::sleep(bool mode)
@@ -200,9 +357,9 @@ void ST7567_FB::sleep(bool mode)
   if(mode) {
     cls();
     display();
-    CS_ACTIVE;
-    sendCmd(ST7567_DISPLAY_OFF); // power down
-    sendCmd(ST7567_DISPLAY_TEST); // all pixels on (saves power)
+    queueCmd(ST7567_DISPLAY_OFF); // power down
+    queueCmd(ST7567_DISPLAY_TEST); // all pixels on (saves power)
+    sendCmds();
     CS_IDLE;
   } else initCmds();
 }
@@ -210,49 +367,65 @@ void ST7567_FB::sleep(bool mode)
 // 0..31
 void ST7567_FB::setContrast(byte val)
 {
-  CS_ACTIVE;
-  sendCmd(ST7567_VOLUME_FIRST);
-  sendCmd(ST7567_VOLUME_SECOND | (val & 0x3f));
+  queueCmd(ST7567_VOLUME_FIRST);
+  queueCmd(ST7567_VOLUME_SECOND | (val & 0x3f));
+  sendCmds();
   CS_IDLE;
 }
 // ----------------------------------------------------------------
 // 0..63
 void ST7567_FB::setScroll(byte val)
 {
-  CS_ACTIVE;
-  sendCmd(ST7567_SCAN_START_LINE|(val&0x3f));
+  queueCmd(ST7567_SCAN_START_LINE|(val&0x3f));
+  sendCmds();
   CS_IDLE;
 }
 // ----------------------------------------------------------------
-// 0..3, only 0 and 2 supported on ST7567
+// 0..3, 0 and 2 by SEG/COM remap only
+// 1 and 3 swap logical width and height (64x128 canvas), pages are transposed by writeTiles()
+// and SEG/COM remap makes rotation from transposition, hardware scroll works along logical x then
 void ST7567_FB::setRotation(int mode)
 {
+  mode &= 3;
+  if((mode^rotation)&1) setBuffer(scr,scrHtPx,scrWd);
   rotation = mode;
-  CS_ACTIVE;
+  setDirty(); // LCD RAM columns are shifted in modes 2 and 3
+#ifdef USE_SHADOW_BUF
+  shadowValid = false;
+#endif
   switch(mode) {
     case 0:
-      sendCmd(ST7567_SEG_NORMAL);
-      sendCmd(ST7567_COM_REMAP);
+      queueCmd(ST7567_SEG_NORMAL);
+      queueCmd(ST7567_COM_REMAP);
+      break;
+    case 1:
+      queueCmd(ST7567_SEG_NORMAL);
+      queueCmd(ST7567_COM_NORMAL);
       break;
     case 2:
-      sendCmd(ST7567_SEG_REMAP);
-      sendCmd(ST7567_COM_NORMAL);
+      queueCmd(ST7567_SEG_REMAP);
+      queueCmd(ST7567_COM_NORMAL);
+      break;
+    case 3:
+      queueCmd(ST7567_SEG_REMAP);
+      queueCmd(ST7567_COM_REMAP);
       break;
   }
+  sendCmds();
   CS_IDLE;
 }
 // ----------------------------------------------------------------
 void ST7567_FB::displayInvert(bool mode)
 {
-  CS_ACTIVE;
-  sendCmd(mode ? ST7567_INVERT_ON : ST7567_INVERT_OFF);
+  queueCmd(mode ? ST7567_INVERT_ON : ST7567_INVERT_OFF);
+  sendCmds();
   CS_IDLE;
 }
 // ----------------------------------------------------------------
 void ST7567_FB::displayOn(bool mode)
 {
-  CS_ACTIVE;
-  sendCmd(mode ? ST7567_DISPLAY_ON : ST7567_DISPLAY_OFF);
+  queueCmd(mode ? ST7567_DISPLAY_ON : ST7567_DISPLAY_OFF);
+  sendCmds();
   CS_IDLE;
 }
 // ----------------------------------------------------------------
@@ -260,44 +433,451 @@ void ST7567_FB::displayOn(bool mode)
 //     ST7567_INVERT_OFF, ST7567_INVERT_ON, ST7567_DISPLAY_ON, ST7567_DISPLAY_OFF
 void ST7567_FB::displayMode(byte val)
 {
-  CS_ACTIVE;
-  sendCmd(val);
+  queueCmd(val);
+  sendCmds();
   CS_IDLE;
 }
 // ----------------------------------------------------------------
 void ST7567_FB::display()
 {
-  for(int y8=0; y8<SCR_HT8; y8++) {
-    gotoXY(rotation?4:0,y8);
-    //CS_ACTIVE;
-    DC_DATA;
-    for(int x=0; x<SCR_WD; x++) sendSPI(scr[x+y8*SCR_WD]);
+  STAT_FLUSH;
+#ifdef USE_PAGE_MODE
+  if(dlMode==DL_REC) { dlReplay(); return; }
+#endif
+  writeFrame(scr);
+  clearDirty();
+#ifdef USE_SHADOW_BUF
+  memcpy(shadow,scr,scrWd*scrHt);
+  shadowValid = true;
+#endif
+}
+// ----------------------------------------------------------------
+// send only changed parts of pages, much faster when small area was modified
+void ST7567_FB::displayDirty()
+{
+  STAT_FLUSH;
+#ifdef USE_PAGE_MODE
+  if(dlMode==DL_REC) { display(); return; }
+#endif
+#ifdef USE_DIRTY_TRACKING
+  if(rotation&1) {
+    // LCD page p gets run of tiles from first to last logical page changed in its 8 columns
+    for(uint8_t p=0; p<scrWd/8; p++) {
+      uint8_t lp0, lp1;
+      dirtyTiles(p,lp0,lp1);
+      if(lp0>lp1) continue;
+      writeTiles(scr,p*8,p*8+7,lp0,lp1);
+#ifdef USE_SHADOW_BUF
+      for(uint8_t y8=lp0; y8<=lp1; y8++) memcpy(shadow+y8*scrWd+p*8,scr+y8*scrWd+p*8,8);
+#endif
+    }
+    clearDirty();
+    return;
   }
-  CS_IDLE;
+  for(int y8=0; y8<scrHt; y8++) {
+    if(dirtyMin[y8]>dirtyMax[y8]) continue;
+    uint8_t x0 = dirtyMin[y8];
+    uint8_t x1 = dirtyMax[y8]<scrWd ? dirtyMax[y8] : scrWd-1;
+    writePage(x0,y8,scr+x0+y8*scrWd,x1-x0+1);
+#ifdef USE_SHADOW_BUF
+    memcpy(shadow+x0+y8*scrWd,scr+x0+y8*scrWd,x1-x0+1);
+#endif
+  }
+  clearDirty();
+#else
+  display();
+#endif
+}
+// ----------------------------------------------------------------
+// gotoXY() costs 4 command bytes, unchanged gaps up to this length are sent as data
+#define ADDR_COST 4
+
+// compare framebuffer with copy of LCD RAM and send only changed runs of bytes
+// works also when scr[] is modified directly
+void ST7567_FB::displayDiff()
+{
+  STAT_FLUSH;
+#ifdef USE_PAGE_MODE
+  if(dlMode==DL_REC) { display(); return; }
+#endif
+#ifdef USE_SHADOW_BUF
+  if(!shadowValid) { display(); bytesSaved = 0; return; }
+  int sent = 0;
+  for(int y8=0; y8<scrHt; y8++) {
+    byte *s = scr+y8*scrWd, *d = shadow+y8*scrWd;
+    int x = 0;
+    while(x<scrWd) {
+      while(x<scrWd && s[x]==d[x]) x++;
+      if(x>=scrWd) break;
+      int xs = x, xe = x;
+      for(x++; x<scrWd && x-xe<=ADDR_COST; x++) if(s[x]!=d[x]) xe = x;
+      writePage(xs,y8,s+xs,xe-xs+1);
+      memcpy(d+xs,s+xs,xe-xs+1);
+      x = xe+1;
+      sent += ADDR_COST+xe-xs+1;
+    }
+  }
+  clearDirty();
+  bytesSaved = scrHt*(ADDR_COST+scrWd)-sent;
+#else
+  display();
+#endif
+}
+// ----------------------------------------------------------------
+#ifdef USE_STATS
+void ST7567_FB::resetStats()
+{
+  memset(&stats,0,sizeof(stats));
+  stats.cur = STAT_PRIMS;
+}
+// ----------------------------------------------------------------
+#endif
+void ST7567_FB::setDirty()
+{
+#ifdef USE_DIRTY_TRACKING
+  memset(dirtyMin,0,sizeof(dirtyMin));
+  memset(dirtyMax,scrWd-1,sizeof(dirtyMax));
+#endif
+}
+// ----------------------------------------------------------------
+void ST7567_FB::clearDirty()
+{
+#ifdef USE_DIRTY_TRACKING
+  memset(dirtyMin,0xff,sizeof(dirtyMin));
+  memset(dirtyMax,0,sizeof(dirtyMax));
+#endif
+}
+// ----------------------------------------------------------------
+#ifdef USE_DIRTY_TRACKING
+// portrait: first and last logical page changed in 8 columns of LCD page p, lp0>lp1 when none
+void ST7567_FB::dirtyTiles(uint8_t p, uint8_t &lp0, uint8_t &lp1)
+{
+  lp0 = 0xff; lp1 = 0;
+  for(uint8_t y8=0; y8<scrHt; y8++)
+    if(dirtyMin[y8]<=dirtyMax[y8] && dirtyMin[y8]<=p*8+7 && dirtyMax[y8]>=p*8) { if(lp0>y8) lp0 = y8; lp1 = y8; }
+}
+#endif
+// ----------------------------------------------------------------
+// non-blocking version of display()/displayDirty(), call flushStep() from loop until it returns true
+void ST7567_FB::beginFlush(bool dirtyOnly)
+{
+#ifdef USE_PAGE_MODE
+  if(dlMode==DL_REC) { display(); flushY8 = scrHt; return; }
+#endif
+  flushAll = !dirtyOnly;
+#ifndef USE_DIRTY_TRACKING
+  flushAll = true;
+#else
+  if(rotation&1) { // LCD page covers all logical pages, so dirty tiles are taken now and drawing from now on goes to the next flush
+    if(!flushAll) for(uint8_t p=0; p<scrWd/8; p++) dirtyTiles(p,flushLp0[p],flushLp1[p]);
+    clearDirty();
+  }
+#endif
+  flushY8 = 0;
+  flushX = 1; flushXe = 0;  // no page started yet
+}
+// ----------------------------------------------------------------
+// sends at most maxBytes of data, each call starts with gotoXY() so the bus can be used by others in between
+bool ST7567_FB::flushStep(uint16_t maxBytes)
+{
+  if(bus->busy()) return false;  // previous chunk still in progress
+  if(rotation&1) {
+    // LCD page flushY8 gets transposed tiles of logical pages flushX..flushXe
+    while(maxBytes && flushY8<scrWd/8) {
+      if(flushX>flushXe) { // next LCD page
+        flushX = 0; flushXe = scrHt-1;
+#ifdef USE_DIRTY_TRACKING
+        if(!flushAll) { flushX = flushLp0[flushY8]; flushXe = flushLp1[flushY8]; }
+#endif
+        if(flushX>flushXe) { flushY8++; continue; }
+      }
+      uint8_t n = flushXe-flushX+1;
+      if(n*8>maxBytes) n = maxBytes>8 ? maxBytes/8 : 1;
+      writeTiles(scr,flushY8*8,flushY8*8+7,flushX,flushX+n-1);
+#ifdef USE_SHADOW_BUF
+      for(uint8_t y8=flushX; y8<flushX+n; y8++) memcpy(shadow+y8*scrWd+flushY8*8,scr+y8*scrWd+flushY8*8,8);
+#endif
+      flushX += n;
+      maxBytes = maxBytes>n*8 ? maxBytes-n*8 : 0;
+      if(flushX>flushXe) flushY8++;
+    }
+    if(flushY8>=scrWd/8) flushY8 = scrHt;
+    return flushDone();
+  }
+  while(maxBytes && flushY8<scrHt) {
+    if(flushX>flushXe) { // next page
+      if(flushAll) { flushX = 0; flushXe = scrWd-1; }
+#ifdef USE_DIRTY_TRACKING
+      else {
+        flushX = dirtyMin[flushY8];
+        flushXe = dirtyMax[flushY8]<scrWd ? dirtyMax[flushY8] : scrWd-1;
+      }
+      // drawing done from now on marks the page again
+      dirtyMin[flushY8] = 0xff;
+      dirtyMax[flushY8] = 0;
+#endif
+      if(flushX>flushXe) { flushY8++; continue; }
+    }
+    uint8_t n = flushXe-flushX+1;
+    if(n>maxBytes) n = maxBytes;
+    byte *s = scr+flushY8*scrWd+flushX;
+    writePage(flushX,flushY8,s,n);
+#ifdef USE_SHADOW_BUF
+    memcpy(shadow+flushY8*scrWd+flushX,s,n);
+#endif
+    flushX += n;
+    maxBytes -= n;
+    if(flushX>flushXe) flushY8++;
+  }
+  return flushY8>=scrHt;
 }
 // ----------------------------------------------------------------
 // copy only part of framebuffer
+
 void ST7567_FB::copy(uint8_t x, uint8_t y8, uint8_t wd, uint8_t ht8)
 {
-  uint8_t wdb = wd;
+  STAT_FLUSH;
+#ifdef USE_PAGE_MODE
+  if(dlMode==DL_REC) { display(); return; }
+#endif
+  if(rotation&1) writeTiles(scr,x,x+wd-1,y8,y8+ht8-1);
   for(int i=0; i<ht8; i++) {
-    gotoXY(x+(rotation?4:0),y8+i);
-    //CS_ACTIVE;
-    DC_DATA;
-    for(int x=0; x<wd; x++) sendSPI(*(scr+wdb*i+x));
+    byte *s = scr+(y8+i)*scrWd+x;
+    if(!(rotation&1)) writePage(x,y8+i,s,wd);
+#ifdef USE_SHADOW_BUF
+    memcpy(shadow+(y8+i)*scrWd+x,s,wd);
+#endif
   }
-  CS_IDLE;
+}
+#ifdef USE_PAGE_MODE
+// ----------------------------------------------------------------
+// page mode, drawing calls are kept in display list and replayed for each page into 1 page band
+// ----------------------------------------------------------------
+void ST7567_FB::beginPageMode(byte *band, byte *list, uint16_t listSize)
+{
+  dlFb = scr;
+  dlBand = band;
+  dlBuf = list;
+  dlSize = listSize;
+  dlMode = DL_REC;
+  cls();
+}
+// ----------------------------------------------------------------
+void ST7567_FB::endPageMode()
+{
+  scr = dlFb;
+  dlMode = DL_OFF;
+  resetClip();
+  setDirty();
+}
+// ----------------------------------------------------------------
+// fmt: b - byte, w - 16-bit int, p - pointer, s - string copied into the list,
+//      P - current dither pattern, T - current text settings
+// calls which don't fit are dropped and dlOverflow is set
+void ST7567_FB::dlPut(uint8_t op, const char *fmt, ...)
+{
+  va_list ap;
+  va_start(ap,fmt);
+  uint16_t n = dlLen;
+  bool ok = n<dlSize;
+  if(ok) dlBuf[n++] = op;
+  for(; ok && *fmt; fmt++) {
+    byte tmp[sizeof(void*)+6];
+    const void *src = tmp;
+    uint16_t sz;
+    switch(*fmt) {
+      case 'b': tmp[0] = va_arg(ap,int); sz = 1; break;
+      case 'w': { int16_t v = va_arg(ap,int); memcpy(tmp,&v,2); sz = 2; } break;
+      case 'p': { const void *v = va_arg(ap,const void*); memcpy(tmp,&v,sizeof(v)); sz = sizeof(v); } break;
+      case 's': src = va_arg(ap,const char*); sz = strlen((const char*)src)+1; break;
+      case 'a': src = va_arg(ap,const int16_t*); sz = 2*va_arg(ap,int); break;  // array of words and its length
+      case 'P': src = pattern; sz = 4; break;
+      case 'T':
+        memcpy(tmp,&cfont.font,sizeof(void*));
+        sz = sizeof(void*);
+        tmp[sz++] = cfont.minCharWd;
+        tmp[sz++] = cfont.minDigitWd;
+        tmp[sz++] = spacing;
+        tmp[sz++] = invertCh;
+        tmp[sz++] = opaque;
+        tmp[sz++] = cr;
+        break;
+      default: sz = 0; break;
+    }
+    if(n+sz>dlSize) ok = false;
+    else { memcpy(dlBuf+n,src,sz); n += sz; }
+  }
+  va_end(ap);
+  if(ok) dlLen = n; else dlOverflow = true;
+}
+// ----------------------------------------------------------------
+static inline int16_t dlW(const byte *&p) { int16_t v; memcpy(&v,p,2); p+=2; return v; }
+static inline const uint8_t *dlP(const byte *&p) { const uint8_t *v; memcpy(&v,p,sizeof(v)); p+=sizeof(v); return v; }
+// ----------------------------------------------------------------
+// text settings recorded with 'T'
+void ST7567_FB::dlText(const byte *&p)
+{
+  const uint8_t *f = dlP(p);
+  if(f!=cfont.font) {
+    bool (*num)(uint8_t) = isNumberFun;  // not changed by setFont() in user code
+    setFont(f);
+    isNumberFun = num;
+  }
+  cfont.minCharWd = p[0];
+  cfont.minDigitWd = p[1];
+  spacing = p[2];
+  invertCh = p[3];
+  opaque = p[4];
+  cr = p[5];
+  p += 6;
 }
+// ----------------------------------------------------------------
+// whole list is replayed for each page, everything outside the band is clipped
+void ST7567_FB::dlReplay()
+{
+  // drawing settings are changed by the list, current ones are restored at the end
+  _propFont font = cfont;
+  byte pat[4];
+  memcpy(pat,pattern,4);
+  uint8_t sp = spacing, inv = invertCh, opq = opaque, crm = cr;
+  bool (*num)(uint8_t) = isNumberFun;
+  uint8_t cx0 = clipX0, cy0 = clipY0, cx1 = clipX1, cy1 = clipY1;
+
+  dlMode = DL_PLAY;
+  for(dlY8=0; dlY8<scrHt; dlY8++) {
+    scr = dlBand-dlY8*scrWd;  // band is page dlY8 of virtual frame buffer
+    while(bus->busy());  // previous band still being sent
+    memset(dlBand,0,scrWd);
+    resetClip();
+    const byte *p = dlBuf, *e = dlBuf+dlLen;
+    while(p<e) {
+      switch(*p++) {
+        case OP_CLIP:     setClip(p[0],p[1],p[2],p[3]); p+=4; break;
+        case OP_PIXEL:    drawPixel(p[0],p[1],p[2]); p+=3; break;
+        case OP_LINE:
+        case OP_LINED: {
+          int16_t v[4];
+          memcpy(v,p,8);
+          if(p[-1]==OP_LINE) drawLine(v[0],v[1],v[2],v[3],p[8]);
+          else { memcpy(pattern,p+9,4); drawLineD(v[0],v[1],v[2],v[3],p[8]); p+=4; }
+          p+=9;
+          break;
+        }
+        case OP_LINEH:    drawLineH(p[0],p[1],p[2],p[3]); p+=4; break;
+        case OP_LINEV:    drawLineV(p[0],p[1],p[2],p[3]); p+=4; break;
+        case OP_LINEHF:   drawLineHfast(p[0],p[1],p[2],p[3]); p+=4; break;
+        case OP_LINEHFD:  drawLineHfastD(p[0],p[1],p[2],p[3]); p+=4; break;
+        case OP_LINEVF:   drawLineVfast(p[0],p[1],p[2],p[3]); p+=4; break;
+        case OP_LINEVFD:  memcpy(pattern,p+4,4); drawLineVfastD(p[0],p[1],p[2],p[3]); p+=8; break;
+        case OP_RECT:     drawRect(p[0],p[1],p[2],p[3],p[4]); p+=5; break;
+        case OP_RECTD:    memcpy(pattern,p+5,4); drawRectD(p[0],p[1],p[2],p[3],p[4]); p+=9; break;
+        case OP_FILL:     fillRect(p[0],p[1],p[2],p[3],p[4]); p+=5; break;
+        case OP_FILLD:    memcpy(pattern,p+5,4); fillRectD(p[0],p[1],p[2],p[3],p[4]); p+=9; break;
+        case OP_CIRCLE:   drawCircle(p[0],p[1],p[2],p[3]); p+=4; break;
+        case OP_FCIRCLE:  fillCircle(p[0],p[1],p[2],p[3]); p+=4; break;
+        case OP_FCIRCLED: memcpy(pattern,p+4,4); fillCircleD(p[0],p[1],p[2],p[3]); p+=8; break;
+        case OP_FTRI:
+        case OP_FTRID: {
+          int16_t v[6];
+          memcpy(v,p,12);
+          if(p[-1]==OP_FTRI) fillTriangle(v[0],v[1],v[2],v[3],v[4],v[5],p[12]);
+          else { memcpy(pattern,p+13,4); fillTriangleD(v[0],v[1],v[2],v[3],v[4],v[5],p[12]); p+=4; }
+          p+=13;
+          break;
+        }
+        case OP_FPOLY:
+        case OP_FPOLYD: {
+          int16_t v[2*POLY_MAX_PTS];
+          uint8_t n = p[0], col = p[1], op = p[-1];
+          memcpy(v,p+2,n*4);
+          p+=2+n*4;
+          if(op==OP_FPOLY) fillPolygon(v,n,col);
+          else { memcpy(pattern,p,4); fillPolygonD(v,n,col); p+=4; }
+          break;
+        }
+        case OP_BLIT: {
+          const uint8_t *src = dlP(p);
+          uint8_t cst = p[0], rst = p[1];
+          p+=2;
+          int16_t x = dlW(p), y = dlW(p);
+          uint8_t w = p[0], h = p[1], rop = p[2];
+          p+=3;
+          blit(src,cst,rst,x,y,w,h,rop,dlP(p));
+          break;
+        }
+        case OP_BLITRLE: {
+          const uint8_t *bmp = dlP(p);
+          int16_t x = dlW(p), y = dlW(p);
+          blitRLE(bmp,x,y,*p++);
+          break;
+        }
+        case OP_CHAR:
+        case OP_STR: {
+          uint8_t op = p[-1];
+          int16_t x = dlW(p), y = dlW(p);
+          dlText(p);
+          // rows are known unless the text wraps
+          bool skip = !cr && (y>=clipY1 || y+cfont.ySize<=clipY0);
+          if(op==OP_CHAR) { if(!skip) printChar(x,y,*p); p++; }
+          else { if(!skip) printStr(x,y,(char*)p); p += strlen((const char*)p)+1; }
+          break;
+        }
+        default: p = e; break;  // corrupted list
+      }
+    }
+    writePage(0,dlY8,dlBand,scrWd);
+  }
+  dlMode = DL_REC;
+
+  if(font.font && font.font!=cfont.font) setFont(font.font);
+  cfont = font;
+  memcpy(pattern,pat,4);
+  spacing = sp; invertCh = inv; opaque = opq; cr = crm;
+  isNumberFun = num;
+  clipX0 = cx0; clipY0 = cy0; clipX1 = cx1; clipY1 = cy1;
+  clearDirty();
+}
+#endif
+
 // ----------------------------------------------------------------
 // ----------------------------------------------------------------
 void ST7567_FB::cls()
 {
-  memset(scr,0,SCR_WD*SCR_HT8);
+#ifdef USE_PAGE_MODE
+  if(dlMode==DL_REC) { // new frame, start with current clipping
+    dlLen = 0;
+    dlOverflow = false;
+    dlPut(OP_CLIP,"bbbb",clipX0,clipY0,clipX1-clipX0,clipY1-clipY0);
+    return;
+  }
+#endif
+  memset(scr,0,scrWd*scrHt);
+  setDirty();
+}
+// ----------------------------------------------------------------
+// all drawing functions are limited to this rectangle
+void ST7567_FB::setClip(uint8_t x, uint8_t y, uint8_t w, uint8_t h)
+{
+  int16_t x1 = x+w, y1 = y+h, ylo = 0, yhi = scrHtPx;
+#ifdef USE_PAGE_MODE
+  if(dlMode==DL_REC) dlPut(OP_CLIP,"bbbb",x,y,w,h);
+  if(dlMode==DL_PLAY) { ylo = dlY8*8; yhi = ylo+8; }  // only current page is in the band
+#endif
+  if(x1>scrWd) x1 = scrWd;
+  if(y1>yhi) y1 = yhi;
+  if(y<ylo) y = ylo;
+  clipX0 = x;
+  clipY0 = y;
+  clipX1 = x1>x ? x1 : x;
+  clipY1 = y1>y ? y1 : y;
 }
 // ----------------------------------------------------------------
 void ST7567_FB::drawPixel(uint8_t x, uint8_t y, uint8_t col) 
 {
-  if(x>=SCR_WD || y>=SCR_HT) return;
+  STAT_CALL(STAT_PIXEL);
+  PAGE_REC(OP_PIXEL,"bbb",x,y,col);
+  if(x<clipX0 || x>=clipX1 || y<clipY0 || y>=clipY1) return;
+  markDirty(x,x,y/8,y/8);
   switch(col) {
     case 1: scr[(y/8)*scrWd+x] |=   (1 << (y&7)); break;
     case 0: scr[(y/8)*scrWd+x] &=  ~(1 << (y&7)); break;
@@ -305,32 +885,33 @@ void ST7567_FB::drawPixel(uint8_t x, uint8_t y, uint8_t col)
   }
 }
 // ----------------------------------------------------------------
-void ST7567_FB::drawLine(int8_t x0, int8_t y0, int8_t x1, int8_t y1, uint8_t col)
+void ST7567_FB::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t col)
 {
-  int dx = abs(x1-x0);
-  int dy = abs(y1-y0);
-  int sx = (x0 < x1) ? 1 : -1;
-  int sy = (y0 < y1) ? 1 : -1;
-  int err = dx - dy;
- 
-  while(1) {
-    //if(x0>=0 && y0>=0) 
-      drawPixel(x0, y0, col);
-    if(x0==x1 && y0==y1) return;
-    int err2 = err+err;
-    if(err2>-dy) { err-=dy; x0+=sx; }
-    if(err2< dx) { err+=dx; y0+=sy; }
-  }
+  STAT_CALL(STAT_LINE);
+  PAGE_REC(OP_LINE,"wwwwb",x0,y0,x1,y1,col);
+  drawLineKernel(x0,y0,x1,y1,col,false);
+}
+// ----------------------------------------------------------------
+// dithered version
+void ST7567_FB::drawLineD(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t col)
+{
+  STAT_CALL(STAT_LINE);
+  PAGE_REC(OP_LINED,"wwwwbP",x0,y0,x1,y1,col);
+  drawLineKernel(x0,y0,x1,y1,col,true);
 }
 // ----------------------------------------------------------------
 void ST7567_FB::drawLineH(uint8_t x0, uint8_t x1, uint8_t y, uint8_t col)
 {
+  STAT_CALL(STAT_LINE);
+  PAGE_REC(OP_LINEH,"bbbb",x0,x1,y,col);
   if(x1>x0) for(uint8_t x=x0; x<=x1; x++) drawPixel(x,y,col);
   else      for(uint8_t x=x1; x<=x0; x++) drawPixel(x,y,col);
 }
 // ----------------------------------------------------------------
 void ST7567_FB::drawLineV(uint8_t x, uint8_t y0, uint8_t y1, uint8_t col)
 {
+  STAT_CALL(STAT_LINE);
+  PAGE_REC(OP_LINEV,"bbbb",x,y0,y1,col);
   if(y1>y0) for(uint8_t y=y0; y<=y1; y++) drawPixel(x,y,col);
   else      for(uint8_t y=y1; y<=y0; y++) drawPixel(x,y,col);
 }
@@ -338,8 +919,14 @@ void ST7567_FB::drawLineV(uint8_t x, uint8_t y0, uint8_t y1, uint8_t col)
 // about 4x faster than regular drawLineH
 void ST7567_FB::drawLineHfast(uint8_t x0, uint8_t x1, uint8_t y, uint8_t col)
 {
+  STAT_CALL(STAT_LINE);
+  PAGE_REC(OP_LINEHF,"bbbb",x0,x1,y,col);
   uint8_t mask;
   if(x1<x0) { mask=x0; x0=x1; x1=mask; } // swap
+  if(y<clipY0 || y>=clipY1 || x1<clipX0 || x0>=clipX1) return;
+  if(x0<clipX0) x0=clipX0;
+  if(x1>=clipX1) x1=clipX1-1;
+  markDirty(x0,x1,y/8,y/8);
   mask = 1 << (y&7);
   switch(col) {
     case 1: for(int x=x0; x<=x1; x++) scr[(y/8)*scrWd+x] |= mask;   break;
@@ -351,8 +938,14 @@ void ST7567_FB::drawLineHfast(uint8_t x0, uint8_t x1, uint8_t y, uint8_t col)
 // limited to pattern #8
 void ST7567_FB::drawLineHfastD(uint8_t x0, uint8_t x1, uint8_t y, uint8_t col)
 {
+  STAT_CALL(STAT_LINE);
+  PAGE_REC(OP_LINEHFD,"bbbb",x0,x1,y,col);
   uint8_t mask;
   if(x1<x0) { mask=x0; x0=x1; x1=mask; } // swap
+  if(y<clipY0 || y>=clipY1 || x1<clipX0 || x0>=clipX1) return;
+  if(x0<clipX0) x0=clipX0;
+  if(x1>=clipX1) x1=clipX1-1;
+  markDirty(x0,x1,y/8,y/8);
   if(((x0&1)==1 && (y&1)==0) || ((x0&1)==0 && (y&1)==1)) x0++;
   mask = 1 << (y&7);
   switch(col) {
@@ -364,17 +957,20 @@ void ST7567_FB::drawLineHfastD(uint8_t x0, uint8_t x1, uint8_t y, uint8_t col)
 // ----------------------------------------------------------------
 byte ST7567_FB::ystab[8]={0xff,0xfe,0xfc,0xf8,0xf0,0xe0,0xc0,0x80};
 byte ST7567_FB::yetab[8]={0x01,0x03,0x07,0x0f,0x1f,0x3f,0x7f,0xff};
-byte ST7567_FB::pattern[4]={0xaa,0x55,0xaa,0x55};
 // about 40x faster than regular drawLineV
 void ST7567_FB::drawLineVfast(uint8_t x, uint8_t y0, uint8_t y1, uint8_t col)
 {
-  if(x<0 || x>SCR_WD) return;
+  STAT_CALL(STAT_LINE);
+  PAGE_REC(OP_LINEVF,"bbbb",x,y0,y1,col);
+  if(x<clipX0 || x>=clipX1) return;
   int y8s,y8e;
   if(y1<y0) { y8s=y1; y1=y0; y0=y8s; } // swap
-  if(y0<0) y0=0;
-  if(y1>=SCR_WD) y1=SCR_WD-1;
+  if(y0>=clipY1 || y1<clipY0) return;
+  if(y0<clipY0) y0=clipY0;
+  if(y1>=clipY1) y1=clipY1-1;
   y8s=y0/8;
   y8e=y1/8;
+  markDirty(x,x,y8s,y8e);
 
   switch(col) {
     case 1: 
@@ -398,10 +994,17 @@ void ST7567_FB::drawLineVfast(uint8_t x, uint8_t y0, uint8_t y1, uint8_t col)
 // dithered version
 void ST7567_FB::drawLineVfastD(uint8_t x, uint8_t y0, uint8_t y1, uint8_t col)
 {
+  STAT_CALL(STAT_LINE);
+  PAGE_REC(OP_LINEVFD,"bbbbP",x,y0,y1,col);
+  if(x<clipX0 || x>=clipX1) return;
   int y8s,y8e;
   if(y1<y0) { y8s=y1; y1=y0; y0=y8s; } // swap
+  if(y0>=clipY1 || y1<clipY0) return;
+  if(y0<clipY0) y0=clipY0;
+  if(y1>=clipY1) y1=clipY1-1;
   y8s=y0/8;
   y8e=y1/8;
+  markDirty(x,x,y8s,y8e);
 
   switch(col) {
     case 1: 
@@ -422,49 +1025,202 @@ void ST7567_FB::drawLineVfastD(uint8_t x, uint8_t y0, uint8_t y1, uint8_t col)
   }
 }
 // ----------------------------------------------------------------
+// each pixel is drawn once, so XOR mode works also for w or h < 3
 void ST7567_FB::drawRect(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t col)
 {
-  if(x>=SCR_WD || y>=SCR_HT) return;
-  byte drawVright=1;
-  if(x+w>SCR_WD) { w=SCR_WD-x; drawVright=0; }
-  if(y+h>SCR_HT) h=SCR_HT-y; else drawLineHfast(x, x+w-1, y+h-1,col);
-  drawLineHfast(x, x+w-1, y,col);
-  drawLineVfast(x,    y+1, y+h-2,col);
-  if(drawVright) drawLineVfast(x+w-1,y+1, y+h-2,col);
+  STAT_CALL(STAT_RECT);
+  PAGE_REC(OP_RECT,"bbbbb",x,y,w,h,col);
+  if(x>=scrWd || y>=scrHtPx || w==0 || h==0) return;
+  int x1 = x+w-1, y1 = y+h-1;
+  drawLineHfast(x, x1<scrWd ? x1 : scrWd-1, y,col);
+  if(h>1 && y1<scrHtPx) drawLineHfast(x, x1<scrWd ? x1 : scrWd-1, y1,col);
+  if(h>2) {
+    if(y1>scrHtPx) y1=scrHtPx; // bottom line clipped, draw vertical lines to the last row
+    drawLineVfast(x,y+1,y1-1,col);
+    if(w>1 && x1<scrWd) drawLineVfast(x1,y+1,y1-1,col);
+  }
 }
 // ----------------------------------------------------------------
 // dithered version
 void ST7567_FB::drawRectD(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t col)
 {
-  if(x>=SCR_WD || y>=SCR_HT) return;
-  byte drawVright=1;
-  if(x+w>SCR_WD) { w=SCR_WD-x; drawVright=0; }
-  if(y+h>SCR_HT) h=SCR_HT-y; else drawLineHfastD(x, x+w-1, y+h-1,col);
-  drawLineHfastD(x, x+w-1, y,col);
-  drawLineVfastD(x,    y+1, y+h-2,col);
-  if(drawVright) drawLineVfastD(x+w-1,y+1, y+h-2,col);
+  STAT_CALL(STAT_RECT);
+  PAGE_REC(OP_RECTD,"bbbbbP",x,y,w,h,col);
+  if(x>=scrWd || y>=scrHtPx || w==0 || h==0) return;
+  int x1 = x+w-1, y1 = y+h-1;
+  drawLineHfastD(x, x1<scrWd ? x1 : scrWd-1, y,col);
+  if(h>1 && y1<scrHtPx) drawLineHfastD(x, x1<scrWd ? x1 : scrWd-1, y1,col);
+  if(h>2) {
+    if(y1>scrHtPx) y1=scrHtPx;
+    drawLineVfastD(x,y+1,y1-1,col);
+    if(w>1 && x1<scrWd) drawLineVfastD(x1,y+1,y1-1,col);
+  }
 }
+
 // ----------------------------------------------------------------
 void ST7567_FB::fillRect(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t col)
 {
-  if(x>=SCR_WD || y>=SCR_HT || w<=0 || h<=0) return;
-  if(x+w>SCR_WD) w=SCR_WD-x;
-  if(y+h>SCR_HT) h=SCR_HT-y;
-  for(int i=x;i<x+w;i++) drawLineVfast(i,y,y+h-1,col);
+  STAT_CALL(STAT_FILL);
+  PAGE_REC(OP_FILL,"bbbbb",x,y,w,h,col);
+  int16_t x1 = x+w, y1 = y+h;
+  if(x<clipX0) x=clipX0;
+  if(y<clipY0) y=clipY0;
+  if(x1>clipX1) x1=clipX1;
+  if(y1>clipY1) y1=clipY1;
+  if(x>=x1 || y>=y1) return;
+  fillRectKernel(x,y,x1-x,y1-y,col,false);
 }
 // ----------------------------------------------------------------
 // dithered version
 void ST7567_FB::fillRectD(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t col)
 {
-  if(x>=SCR_WD || y>=SCR_HT || w<=0 || h<=0) return;
-  if(x+w>=SCR_WD) w=SCR_WD-x;
-  if(y+h>=SCR_HT) h=SCR_HT-y;
-  for(int i=x;i<x+w;i++) drawLineVfastD(i,y,y+h-1,col);
+  STAT_CALL(STAT_FILL);
+  PAGE_REC(OP_FILLD,"bbbbbP",x,y,w,h,col);
+  int16_t x1 = x+w, y1 = y+h;
+  if(x<clipX0) x=clipX0;
+  if(y<clipY0) y=clipY0;
+  if(x1>clipX1) x1=clipX1;
+  if(y1>clipY1) y1=clipY1;
+  if(x>=x1 || y>=y1) return;
+  fillRectKernel(x,y,x1-x,y1-y,col,true);
+}
+// ----------------------------------------------------------------
+static inline void rop8(byte *d, byte m, uint8_t col)
+{
+  switch(col) {
+    case 1: *d |=  m; break;
+    case 0: *d &= ~m; break;
+    case 2: *d ^=  m; break;
+  }
+}
+// ----------------------------------------------------------------
+// fills already clipped rectangle one page row at a time
+// top/bottom masks are applied once per page, full pages use memset, XOR and dithering use 32-bit words
+void ST7567_FB::fillRectKernel(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t col, bool dither)
+{
+  uint8_t y8s = y/8, y8e = (y+h-1)/8;
+  markDirty(x,x+w-1,y8s,y8e);
+  uint32_t pat = 0xffffffff;
+  if(dither) memcpy(&pat,pattern,4);  // bytes for columns 4n+0..4n+3
+  for(uint8_t y8=y8s; y8<=y8e; y8++) {
+    byte mask = 0xff;
+    if(y8==y8s) mask &= ystab[y&7];
+    if(y8==y8e) mask &= yetab[(y+h-1)&7];
+    byte *d = scr+y8*scrWd+x;
+    if(mask==0xff && !dither && col!=2) { memset(d,col?0xff:0,w); continue; }
+    uint32_t m = (mask*0x01010101UL) & pat;
+    byte *mb = (byte*)&m;
+    uint8_t i = 0;
+    for(; i<w && ((x+i)&3); i++) rop8(d+i,mb[(x+i)&3],col);  // until pattern is aligned to words
+    uint32_t v;
+    switch(col) {
+      case 1: for(; i+4<=w; i+=4) { memcpy(&v,d+i,4); v |=  m; memcpy(d+i,&v,4); } break;
+      case 0: for(; i+4<=w; i+=4) { memcpy(&v,d+i,4); v &= ~m; memcpy(d+i,&v,4); } break;
+      case 2: for(; i+4<=w; i+=4) { memcpy(&v,d+i,4); v ^=  m; memcpy(d+i,&v,4); } break;
+    }
+    for(; i<w; i++) rop8(d+i,mb[(x+i)&3],col);
+  }
+}
+// ----------------------------------------------------------------
+// Bresenham line in closed form: after k steps along major axis (length L) minor position is d*k/L
+// rounded half down, so stepping can start at the clipping rectangle
+// returns first step with minor position m, m>=1, d>0
+static inline int32_t lineFirst(uint16_t L, uint16_t d, uint32_t m)
+{
+  uint32_t b = (uint32_t)L*m;
+  int32_t q = b/d, t = 2*(int32_t)(b%d)-L+1;
+  return t>0 ? q+1 : q-(-t)/(2*(int32_t)d);
+}
+
+static inline uint16_t lineMinor(uint16_t L, uint16_t d, uint16_t k)
+{
+  if(!L) return 0;
+  uint32_t a = (uint32_t)d*k;
+  return a/L + (2*(a%L)>L);
 }
+// ----------------------------------------------------------------
+// the same pixels as per pixel Bresenham, 16-bit coordinates, line is clipped before stepping
+// mostly horizontal lines are drawn as runs of bytes in one page row,
+// mostly vertical ones as column spans written once per page
+void ST7567_FB::drawLineKernel(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t col, bool dither)
+{
+  int32_t dx = (int32_t)x1-x0, dy = (int32_t)y1-y0;
+  int8_t sx = dx>0 ? 1 : -1, sy = dy>0 ? 1 : -1;
+  if(dx<0) dx = -dx;
+  if(dy<0) dy = -dy;
+  bool xMajor = dx>=dy;
+  uint16_t L = xMajor ? dx : dy, d = xMajor ? dy : dx;
+  int16_t a0 = xMajor ? x0 : y0, b0 = xMajor ? y0 : x0;
+  int8_t sa = xMajor ? sx : sy, sb = xMajor ? sy : sx;
+  int16_t alo = xMajor ? clipX0 : clipY0, ahi = (xMajor ? clipX1 : clipY1)-1;
+  int16_t blo = xMajor ? clipY0 : clipX0, bhi = (xMajor ? clipY1 : clipX1)-1;
+  // steps k0..k1 and minor positions m0..m1 inside clipping rectangle
+  int32_t k0 = sa>0 ? (int32_t)alo-a0 : (int32_t)a0-ahi, k1 = sa>0 ? (int32_t)ahi-a0 : (int32_t)a0-alo;
+  int32_t m0 = sb>0 ? (int32_t)blo-b0 : (int32_t)b0-bhi, m1 = sb>0 ? (int32_t)bhi-b0 : (int32_t)b0-blo;
+  if(k0<0) k0 = 0;
+  if(k1>L) k1 = L;
+  if(m1<0 || m0>d) return;
+  if(m0>0) { int32_t k = lineFirst(L,d,m0); if(k>k0) k0 = k; }
+  if(m1<d) { int32_t k = lineFirst(L,d,m1+1)-1; if(k<k1) k1 = k; }
+  if(k0>k1) return;
+
+  uint16_t m = lineMinor(L,d,k0);
+  uint8_t x = xMajor ? a0+sa*k0 : b0+sb*m, y = xMajor ? b0+sb*m : a0+sa*k0;
+  // error term of Bresenham, minor position changes when e>0
+  uint32_t a = (uint32_t)d*k0;
+  int32_t e = 2*(int32_t)(L ? a%L : 0)+2*(int32_t)d-L;
+  if(m>(L ? a/L : 0)) e -= 2*(int32_t)L;
+
+  byte am = col==XOR ? 0 : 0xff, xm = col==CLR ? 0 : 0xff;  // b bits: (v & ~(b&am)) ^ (b&xm)
+  uint8_t y8 = y/8;
+  byte *p = scr+y8*scrWd+x;
+  byte bit = 1<<(y&7);
+  int16_t n = k1-k0+1;
+  byte last = sy>0 ? 0x80 : 0x01;  // last row of page in line direction
+  if(xMajor) {
+    uint8_t xs = x;  // first column in current page
+    while(1) {
+      byte b = dither ? bit & pattern[x&3] : bit;
+      *p = (*p & ~(b & am)) ^ (b & xm);
+      if(--n==0) break;
+      if(e>0) {
+        e -= 2*(int32_t)L;
+        if(bit==last) {
+          markDirty(min(xs,x),max(xs,x),y8,y8);
+          y8 += sy; p += sy*scrWd; xs = x+sx;
+        }
+        bit = sy>0 ? bit<<1 | bit>>7 : bit>>1 | bit<<7;
+      }
+      e += 2*(int32_t)d;
+      x += sx; p += sx;
+    }
+    markDirty(min(xs,x),max(xs,x),y8,y8);
+  } else {
+    byte acc = 0;
+    while(1) {
+      acc |= bit;
+      bool done = --n==0, next = e>0;
+      if(done || next || bit==last) {  // column or page changes
+        byte b = dither ? acc & pattern[x&3] : acc;
+        *p = (*p & ~(b & am)) ^ (b & xm);
+        markDirty(x,x,y8,y8);
+        acc = 0;
+      }
+      if(done) break;
+      if(bit==last) { y8 += sy; p += sy*scrWd; }
+      bit = sy>0 ? bit<<1 | bit>>7 : bit>>1 | bit<<7;
+      if(next) { e -= 2*(int32_t)L; x += sx; p += sx; }
+      e += 2*(int32_t)d;
+    }
+  }
+}
+
 // ----------------------------------------------------------------
 // circle
 void ST7567_FB::drawCircle(uint8_t x0, uint8_t y0, uint8_t radius, uint8_t col)
 {
+  STAT_CALL(STAT_CIRCLE);
+  PAGE_REC(OP_CIRCLE,"bbbb",x0,y0,radius,col);
   int f = 1 - (int)radius;
   int ddF_x = 1;
   int ddF_y = -2 * (int)radius;
@@ -492,9 +1248,12 @@ void ST7567_FB::drawCircle(uint8_t x0, uint8_t y0, uint8_t radius, uint8_t col)
   }
 }
 // ----------------------------------------------------------------
+// column tops above the screen are cut to 0, as uint8_t they would wrap and fill the column down to the bottom
 void ST7567_FB::fillCircle(uint8_t x0, uint8_t y0, uint8_t r, uint8_t col)
 {
-  drawLineVfast(x0, y0-r, y0-r+2*r+1, col);
+  STAT_CALL(STAT_CIRCLE);
+  PAGE_REC(OP_FCIRCLE,"bbbb",x0,y0,r,col);
+  drawLineVfast(x0, max(y0-r,0), y0-r+2*r+1, col);
   int16_t f     = 1 - r;
   int16_t ddF_x = 1;
   int16_t ddF_y = -2 * r;
@@ -510,17 +1269,19 @@ void ST7567_FB::fillCircle(uint8_t x0, uint8_t y0, uint8_t r, uint8_t col)
     x++;
     ddF_x += 2;
     f     += ddF_x;
-    drawLineVfast(x0+x, y0-y, y0-y+2*y+1, col);
-    drawLineVfast(x0+y, y0-x, y0-x+2*x+1, col);
-    drawLineVfast(x0-x, y0-y, y0-y+2*y+1, col);
-    drawLineVfast(x0-y, y0-x, y0-x+2*x+1, col);
+    drawLineVfast(x0+x, max(y0-y,0), y0-y+2*y+1, col);
+    drawLineVfast(x0+y, max(y0-x,0), y0-x+2*x+1, col);
+    drawLineVfast(x0-x, max(y0-y,0), y0-y+2*y+1, col);
+    drawLineVfast(x0-y, max(y0-x,0), y0-x+2*x+1, col);
   }
 }
 // ----------------------------------------------------------------
 // dithered version
 void ST7567_FB::fillCircleD(uint8_t x0, uint8_t y0, uint8_t r, uint8_t col)
 {
-  drawLineVfastD(x0, y0-r, y0-r+2*r+1, col);
+  STAT_CALL(STAT_CIRCLE);
+  PAGE_REC(OP_FCIRCLED,"bbbbP",x0,y0,r,col);
+  drawLineVfastD(x0, max(y0-r,0), y0-r+2*r+1, col);
   int16_t f     = 1 - r;
   int16_t ddF_x = 1;
   int16_t ddF_y = -2 * r;
@@ -536,15 +1297,16 @@ void ST7567_FB::fillCircleD(uint8_t x0, uint8_t y0, uint8_t r, uint8_t col)
     x++;
     ddF_x += 2;
     f     += ddF_x;
-    drawLineVfastD(x0+x, y0-y, y0-y+2*y+1, col);
-    drawLineVfastD(x0+y, y0-x, y0-x+2*x+1, col);
-    drawLineVfastD(x0-x, y0-y, y0-y+2*y+1, col);
-    drawLineVfastD(x0-y, y0-x, y0-x+2*x+1, col);
+    drawLineVfastD(x0+x, max(y0-y,0), y0-y+2*y+1, col);
+    drawLineVfastD(x0+y, max(y0-x,0), y0-x+2*x+1, col);
+    drawLineVfastD(x0-x, max(y0-y,0), y0-y+2*y+1, col);
+    drawLineVfastD(x0-y, max(y0-x,0), y0-x+2*x+1, col);
   }
 }
 // ----------------------------------------------------------------
 void ST7567_FB::drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color)
 {
+  STAT_CALL(STAT_TRIANGLE);
   drawLine(x0, y0, x1, y1, color);
   drawLine(x1, y1, x2, y2, color);
   drawLine(x2, y2, x0, y0, color);
@@ -554,6 +1316,8 @@ void ST7567_FB::drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int
 // optimized for ST7567 native frame buffer
 void ST7567_FB::fillTriangle( int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color)
 {
+  STAT_CALL(STAT_TRIANGLE);
+  PAGE_REC(OP_FTRI,"wwwwwwb",x0,y0,x1,y1,x2,y2,color);
   int16_t a, b, x, last;
   if (x0 > x1) { swap(y0, y1); swap(x0, x1); }
   if (x1 > x2) { swap(y2, y1); swap(x2, x1); }
@@ -605,6 +1369,8 @@ void ST7567_FB::fillTriangle( int16_t x0, int16_t y0, int16_t x1, int16_t y1, in
 // optimized for ST7567 native frame buffer
 void ST7567_FB::fillTriangleD( int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color)
 {
+  STAT_CALL(STAT_TRIANGLE);
+  PAGE_REC(OP_FTRID,"wwwwwwbP",x0,y0,x1,y1,x2,y2,color);
   int16_t a, b, x, last;
   if (x0 > x1) { swap(y0, y1); swap(x0, x1); }
   if (x1 > x2) { swap(y2, y1); swap(x2, x1); }
@@ -653,6 +1419,102 @@ void ST7567_FB::fillTriangleD( int16_t x0, int16_t y0, int16_t x1, int16_t y1, i
   }
 }
 // ----------------------------------------------------------------
+// ----------------------------------------------------------------
+void ST7567_FB::fillPolygon(const int16_t *pts, uint8_t n, uint8_t col)
+{
+  if(n>POLY_MAX_PTS) return;
+  STAT_CALL(STAT_POLYGON);
+  PAGE_REC(OP_FPOLY,"bba",n,col,pts,n*2);
+  fillPolygonKernel(pts,n,col,false);
+}
+// ----------------------------------------------------------------
+// dithered version
+void ST7567_FB::fillPolygonD(const int16_t *pts, uint8_t n, uint8_t col)
+{
+  if(n>POLY_MAX_PTS) return;
+  STAT_CALL(STAT_POLYGON);
+  PAGE_REC(OP_FPOLYD,"bbaP",n,col,pts,n*2);
+  fillPolygonKernel(pts,n,col,true);
+}
+// ----------------------------------------------------------------
+static inline int32_t floorDiv(int32_t a, int32_t d) { return a>=0 ? a/d : -((d-1-a)/d); }
+
+// edge crossing column centers x+0.5 for x=xs..xe-1, first row below crossing is q+(r>0),
+// q and remainder r of fraction with denominator den are stepped like in Bresenham
+struct PolyEdge {
+  int16_t xs, xe, q, sq;
+  uint16_t r, sr, den;
+  int16_t row() const { return q+(r>0); }
+};
+// ----------------------------------------------------------------
+// scanline fill along x: edge table sorted by first column, active edges sorted by crossing,
+// column x gets vertical spans between pairs of crossings, each pixel is touched once, so XOR works
+// only one division per edge, spans are written page by page as masked bytes
+void ST7567_FB::fillPolygonKernel(const int16_t *pts, uint8_t n, uint8_t col, bool dither)
+{
+  PolyEdge e[POLY_MAX_PTS];
+  uint8_t act[POLY_MAX_PTS];
+  uint8_t ne = 0, na = 0;
+  int16_t xEnd = clipX0;
+  for(uint8_t i=0; i<n; i++) {
+    const int16_t *a = pts+i*2, *b = pts+(i+1<n ? i+1 : 0)*2;
+    if(a[0]==b[0]) continue;  // vertical edges don't cross column centers
+    if(a[0]>b[0]) { const int16_t *t = a; a = b; b = t; }
+    if(b[0]<=clipX0 || a[0]>=clipX1) continue;
+    int16_t xs = a[0]>clipX0 ? a[0] : clipX0;
+    int32_t dx = b[0]-a[0], dy = b[1]-a[1], den = 2*dx;
+    // crossing at xs+0.5 minus half of row: (2*ya-1)/2 + dy*(2k+1)/(2dx)
+    int32_t num = (2L*a[1]-1)*dx + dy*(2L*(xs-a[0])+1);
+    int32_t q = floorDiv(num,den), sq = floorDiv(2*dy,den);
+    PolyEdge pe = { xs, b[0], (int16_t)q, (int16_t)sq, (uint16_t)(num-q*den), (uint16_t)(2*dy-sq*den), (uint16_t)den };
+    if(b[0]>xEnd) xEnd = b[0];
+    uint8_t j = ne++;
+    for(; j>0 && e[j-1].xs>xs; j--) e[j] = e[j-1];
+    e[j] = pe;
+  }
+  if(!ne) return;
+  if(xEnd>clipX1) xEnd = clipX1;
+  uint8_t next = 0;
+  int16_t ymin = clipY1, ymax = -1;
+  for(int16_t x=e[0].xs; x<xEnd; x++) {
+    uint8_t k = 0;
+    for(uint8_t i=0; i<na; i++) if(e[act[i]].xe>x) act[k++] = act[i];
+    na = k;
+    while(next<ne && e[next].xs==x) act[na++] = next++;
+    // crossings move little between columns, insertion sort is almost linear
+    for(uint8_t i=1; i<na; i++) {
+      uint8_t t = act[i];
+      int16_t v = e[t].row();
+      for(k=i; k>0 && e[act[k-1]].row()>v; k--) act[k] = act[k-1];
+      act[k] = t;
+    }
+    byte *d = scr+x;
+    byte pm = dither ? pattern[x&3] : 0xff;
+    for(uint8_t i=0; i+1<na; i+=2) {
+      int16_t y0 = e[act[i]].row(), y1 = e[act[i+1]].row()-1;
+      if(y0<clipY0) y0 = clipY0;
+      if(y1>=clipY1) y1 = clipY1-1;
+      if(y0>y1) continue;
+      if(y0<ymin) ymin = y0;
+      if(y1>ymax) ymax = y1;
+      uint8_t y8s = y0/8, y8e = y1/8;
+      for(uint8_t y8=y8s; y8<=y8e; y8++) {
+        byte m = pm;
+        if(y8==y8s) m &= ystab[y0&7];
+        if(y8==y8e) m &= yetab[y1&7];
+        rop8(d+y8*scrWd,m,col);
+      }
+    }
+    for(uint8_t i=0; i<na; i++) {
+      PolyEdge &pe = e[act[i]];
+      pe.q += pe.sq;
+      pe.r += pe.sr;
+      if(pe.r>=pe.den) { pe.r -= pe.den; pe.q++; }
+    }
+  }
+  if(ymin<=ymax) markDirty(e[0].xs,xEnd-1,ymin/8,ymax/8);
+}
+// ----------------------------------------------------------------
 const byte ST7567_FB::ditherTab[4*17] PROGMEM = {
   0x00,0x00,0x00,0x00, // 0
 
@@ -695,32 +1557,22 @@ void ST7567_FB::setDither(int8_t s)
 }
 // ----------------------------------------------------------------
 #define ALIGNMENT \
-  if(x==-1) x = SCR_WD-w; \
-  else if(x<0) x = (SCR_WD-w)/2; \
+  if(x==-1) x = scrWd-w; \
+  else if(x<0) x = (scrWd-w)/2; \
   if(x<0) x=0; \
-  if(x>=SCR_WD || y>=SCR_HT) return 0; \
-  if(x+w>SCR_WD) w = SCR_WD-x; \
-  if(y+h>SCR_HT) h = SCR_HT-y
+  if(x>=scrWd || y>=scrHtPx) return 0; \
+  if(x+w>scrWd) w = scrWd-x; \
+  if(y+h>scrHtPx) h = scrHtPx-y
 // ----------------------------------------------------------------
 
 int ST7567_FB::drawBitmap(const uint8_t *bmp, int x, uint8_t y, uint8_t w, uint8_t h)
 {
-  uint8_t wdb = w;
+  uint8_t wdb = w, htb = h;
   ALIGNMENT;
-  byte i,y8,d,b,ht8=(h+7)/8;
-  for(y8=0; y8<ht8; y8++) {
-    for(i=0; i<w; i++) {
-      d = pgm_read_byte(bmp+wdb*y8+i);
-      int lastbit = h - y8 * 8;
-      if (lastbit > 8) lastbit = 8;
-      for(b=0; b<lastbit; b++) {
-         if(d & 1) scr[((y+y8*8+b)/8)*scrWd+x+i] |= (1 << ((y+y8*8+b)&7));
-         d>>=1;
-      }
-    }
-  }
+  blit(bmp,1,wdb,x,y,wdb,htb,SET,NULL);
   return x+w;
 }
+
 // ----------------------------------------------------------------
 int ST7567_FB::drawBitmap(const uint8_t *bmp, int x, uint8_t y)
 {
@@ -728,22 +1580,294 @@ int ST7567_FB::drawBitmap(const uint8_t *bmp, int x, uint8_t y)
   uint8_t h = pgm_read_byte(bmp+1);
   return drawBitmap(bmp+2, x, y, w, h);
 }
+// ----------------------------------------------------------------
+// bitmap with raster operation (SET, CLR, XOR, COPY) and optional transparency mask
+// mask has the same format as bitmap, only pixels set in mask are drawn
+// x and y can be negative or outside the screen, no alignment
+int ST7567_FB::blitBitmap(const uint8_t *bmp, int16_t x, int16_t y, uint8_t rop, const uint8_t *mask)
+{
+  uint8_t w = pgm_read_byte(bmp+0);
+  uint8_t h = pgm_read_byte(bmp+1);
+  return blitBitmap(bmp+2, x, y, w, h, rop, mask ? mask+2 : NULL);
+}
+// ----------------------------------------------------------------
+int ST7567_FB::blitBitmap(const uint8_t *bmp, int16_t x, int16_t y, uint8_t w, uint8_t h, uint8_t rop, const uint8_t *mask)
+{
+  blit(bmp,1,w,x,y,w,h,rop,mask);
+  return x+w;
+}
+// ----------------------------------------------------------------
+// rows of page pg inside clipping range y0..y1-1
+static inline byte pageClip(int16_t pg, uint8_t y0, uint8_t y1)
+{
+  int16_t r = pg*8;
+  if(r+8<=y0 || r>=y1) return 0;
+  byte m = 0xff;
+  if(y0>r) m &= ST7567_FB::ystab[y0&7];
+  if(y1<r+8) m &= ST7567_FB::yetab[(y1-1)&7];
+  return m;
+}
+// ----------------------------------------------------------------
+// source byte d with valid bits m, both already shifted to destination page
+static inline void ropMask(byte *p, byte d, byte m, uint8_t rop)
+{
+  switch(rop) {
+    case SET:  *p |=  d; break;
+    case CLR:  *p &= ~d; break;
+    case XOR:  *p ^=  d; break;
+    case COPY: *p = (*p & ~m) | d; break;
+  }
+}
+// ----------------------------------------------------------------
+// generic byte blitter for PROGMEM (or RAM with SRC_RAM flag in rop) data in native page format
+// source byte for column i and page row y8 is at src[i*colStep+y8*rowStep] (bitmaps: 1,w; fonts: ht8,1)
+// src=NULL means all zero source (background for COPY)
+// every source byte is shifted across 2 destination pages and written as whole bytes
+void ST7567_FB::blit(const uint8_t *src, uint8_t colStep, uint8_t rowStep, int16_t x, int16_t y, uint8_t w, uint8_t h, uint8_t rop, const uint8_t *mask)
+{
+  STAT_CALL(STAT_BITMAP);
+  PAGE_REC(OP_BLIT,"pbbwwbbbp",src,colStep,rowStep,x,y,w,h,rop,mask);
+  int16_t i0 = clipX0-x, i1 = clipX1-x;
+  if(i0<0) i0 = 0;
+  if(i1>w) i1 = w;
+  if(i0>=i1 || h==0 || y>=clipY1 || y+h<=clipY0) return;
+  uint8_t shift = y&7;
+  int16_t pg = (y-shift)/8;
+  int16_t pe = (y+h-1)/8;
+  int16_t cs = clipY0/8, ce = (clipY1-1)/8;
+  markDirty(x+i0,x+i1-1,pg<cs ? cs : pg,pe<ce ? pe : ce);
+  uint8_t ht8 = (h+7)/8;
+  bool ram = rop & SRC_RAM;
+  rop &= ~SRC_RAM;
+  for(uint8_t y8=0; y8<ht8; y8++,pg++) {
+    if(pg+1<cs) continue;
+    if(pg>ce) break;
+    byte valid = y8==ht8-1 ? yetab[(h-1)&7] : 0xff;
+    byte clo = pageClip(pg,clipY0,clipY1), chi = shift ? pageClip(pg+1,clipY0,clipY1) : 0;
+    int16_t olo = pg*scrWd+x, ohi = olo+scrWd;
+    const uint8_t *s = src+y8*rowStep+i0*colStep;
+    const uint8_t *ms = mask ? mask+y8*rowStep+i0*colStep : NULL;
+    for(int16_t i=i0; i<i1; i++, s+=colStep) {
+      byte m = valid;
+      if(ms) { m &= pgm_read_byte(ms); ms+=colStep; }
+      uint16_t d = src ? ((ram ? *s : pgm_read_byte(s)) & m) << shift : 0;
+      uint16_t mm = m << shift;
+      if(clo) ropMask(scr+olo+i,d&clo,mm&clo,rop);
+      if(chi) ropMask(scr+ohi+i,(d>>8)&chi,(mm>>8)&chi,rop);
+    }
+  }
+}
+// ----------------------------------------------------------------
+// compressed bitmap: width, height and page rows (w bytes each, as in regular bitmap) coded as runs:
+// 0x00-0x7f - c+1 literal bytes follow, 0x80-0xbf - c-0x7f zero bytes, 0xc0-0xff - next byte repeated c-0xbf times
+// runs can continue in the next page row, use extras/pbm2rle.py to convert images
+int ST7567_FB::drawBitmapRLE(const uint8_t *bmp, int x, uint8_t y)
+{
+  uint8_t w = pgm_read_byte(bmp+0);
+  if(x==-1) x = scrWd-w;
+  else if(x<0) x = (scrWd-w)/2;
+  if(x<0) x=0;
+  if(x>=scrWd || y>=scrHtPx) return 0;
+  blitRLE(bmp,x,y,SET);
+  return x+w<scrWd ? x+w : scrWd;
+}
+// ----------------------------------------------------------------
+// x and y can be negative or outside the screen, no alignment
+int ST7567_FB::blitBitmapRLE(const uint8_t *bmp, int16_t x, int16_t y, uint8_t rop)
+{
+  blitRLE(bmp,x,y,rop);
+  return x+pgm_read_byte(bmp+0);
+}
+// ----------------------------------------------------------------
+// decoded bytes are shifted and written like in blit(), nothing is buffered
+// zero runs are skipped for SET/CLR/XOR, hidden parts are only decoded
+void ST7567_FB::blitRLE(const uint8_t *bmp, int16_t x, int16_t y, uint8_t rop)
+{
+  STAT_CALL(STAT_BITMAP);
+  PAGE_REC(OP_BLITRLE,"pwwb",bmp,x,y,rop);
+  uint8_t w = pgm_read_byte(bmp+0), h = pgm_read_byte(bmp+1);
+  int16_t i0 = clipX0-x, i1 = clipX1-x;
+  if(i0<0) i0 = 0;
+  if(i1>w) i1 = w;
+  if(i0>=i1 || h==0 || y>=clipY1 || y+h<=clipY0) return;
+  uint8_t shift = y&7;
+  int16_t pg = (y-shift)/8;
+  int16_t pe = (y+h-1)/8;
+  int16_t cs = clipY0/8, ce = (clipY1-1)/8;
+  markDirty(x+i0,x+i1-1,pg<cs ? cs : pg,pe<ce ? pe : ce);
+  const uint8_t *s = bmp+2;
+  uint8_t cnt = 0, val = 0;  // bytes left in current run, val for repeated runs
+  bool lit = false;
+  uint8_t ht8 = (h+7)/8;
+  for(uint8_t y8=0; y8<ht8; y8++,pg++) {
+    byte valid = y8==ht8-1 ? yetab[(h-1)&7] : 0xff;
+    byte clo = pageClip(pg,clipY0,clipY1), chi = shift ? pageClip(pg+1,clipY0,clipY1) : 0;
+    bool vis = clo || chi;
+    int16_t olo = pg*scrWd+x, ohi = olo+scrWd;
+    uint16_t mm = valid << shift;
+    for(int16_t i=0; i<w; ) {
+      if(!cnt) {
+        uint8_t c = pgm_read_byte(s++);
+        lit = c<0x80;
+        if(lit) { cnt = c+1; }
+        else if(c<0xc0) { cnt = c-0x7f; val = 0; }
+        else { cnt = c-0xbf; val = pgm_read_byte(s++); }
+      }
+      uint8_t n = cnt<w-i ? cnt : w-i;
+      cnt -= n;
+      if(!vis || (!lit && !val && rop!=COPY) || i+n<=i0 || i>=i1) {
+        if(lit) s += n;
+        i += n;
+        continue;
+      }
+      // only visible part of the run is written
+      int16_t re = i+n, a = i<i0 ? i0 : i, e = re>i1 ? i1 : re;
+      if(lit) s += a-i;
+      for(i=a; i<e; i++) {
+        byte b = lit ? pgm_read_byte(s++) : val;
+        uint16_t d = (b & valid) << shift;
+        if(clo) ropMask(scr+olo+i,d&clo,mm&clo,rop);
+        if(chi) ropMask(scr+ohi+i,(d>>8)&chi,(mm>>8)&chi,rop);
+      }
+      if(lit) s += re-e;
+      i = re;
+    }
+  }
+}
+// ----------------------------------------------------------------
+// region scrolling
+// ----------------------------------------------------------------
+// swaps only bits m of bytes, used for rotation by reversals
+static void reverseMasked(byte *d, uint8_t n, byte m)
+{
+  for(byte *e=d+n-1; d<e; d++,e--) {
+    byte t = *d;
+    *d = (*d & ~m) | (*e & m);
+    *e = (*e & ~m) | (t & m);
+  }
+}
+// ----------------------------------------------------------------
+// 8 rows starting at row yy (can be negative) of column with n pages, rows outside are 0
+static inline byte columnBits(const byte *c, uint8_t n, int16_t yy)
+{
+  uint8_t r = yy&7;
+  int16_t p = (yy-r)/8;
+  uint16_t v = 0;
+  if(p>=0 && p<n) v = c[p];
+  if(p+1>=0 && p+1<n) v |= c[p+1]<<8;
+  return v>>r;
+}
+// ----------------------------------------------------------------
+// moves contents of rectangle by dx,dy pixels, nothing outside it (and clipping rectangle) is changed
+// fill: 0 or 1 - color of uncovered area, -1 - wrap around
+// columns are moved with memmove per page row, rows are shifted across pages through 16-bit words
+// works on frame buffer only, ignored in page mode
+void ST7567_FB::scrollRegion(uint8_t x, uint8_t y, uint8_t w, uint8_t h, int8_t dx, int8_t dy, int8_t fill)
+{
+  STAT_CALL(STAT_SCROLL);
+#ifdef USE_PAGE_MODE
+  if(dlMode) return;
+#endif
+  int16_t x1 = x+w, y1 = y+h;
+  if(x<clipX0) x=clipX0;
+  if(y<clipY0) y=clipY0;
+  if(x1>clipX1) x1=clipX1;
+  if(y1>clipY1) y1=clipY1;
+  if(x>=x1 || y>=y1) return;
+  w = x1-x; h = y1-y;
+  bool wrap = fill<0;
+  byte fb = fill>0 ? 0xff : 0;
+  int16_t sx = dx, sy = dy;
+  if(wrap) {  // the same as shift right/down
+    sx %= w; if(sx<0) sx += w;
+    sy %= h; if(sy<0) sy += h;
+  } else {
+    if(sx>w) sx = w; else if(sx<-w) sx = -w;
+    if(sy>h) sy = h; else if(sy<-h) sy = -h;
+  }
+  uint8_t y8s = y/8, y8e = (y1-1)/8;
+  markDirty(x,x1-1,y8s,y8e);
+
+  if(sx) {
+    uint8_t s = sx>0 ? sx : -sx;
+    for(uint8_t y8=y8s; y8<=y8e; y8++) {
+      byte m = pageClip(y8,y,y1);
+      byte *d = scr+y8*scrWd+x;
+      if(wrap) {  // rotation right by 3 reversals
+        reverseMasked(d,w,m);
+        reverseMasked(d,s,m);
+        reverseMasked(d+s,w-s,m);
+        continue;
+      }
+      byte *f = sx>0 ? d : d+w-s;  // uncovered columns
+      if(m==0xff) {
+        if(sx>0) memmove(d+s,d,w-s); else memmove(d,d+s,w-s);
+        memset(f,fb,s);
+        continue;
+      }
+      if(sx>0) for(uint8_t i=w-1; i>=s; i--) d[i] = (d[i] & ~m) | (d[i-s] & m);
+      else for(uint8_t i=0; i<w-s; i++) d[i] = (d[i] & ~m) | (d[i+s] & m);
+      for(uint8_t i=0; i<s; i++) f[i] = (f[i] & ~m) | (fb & m);
+    }
+  }
+
+  if(sy) {
+    // rows with source inside the region, the rest is filled or taken from the other end
+    byte mr[SCR_PAGES], mv[SCR_PAGES];
+    int16_t v0 = sy>0 ? y+sy : y, v1 = sy>0 ? y1 : y1+sy;
+    if(wrap) v1 = y1;
+    for(uint8_t y8=y8s; y8<=y8e; y8++) {
+      mr[y8] = pageClip(y8,y,y1);
+      mv[y8] = v0<v1 ? mr[y8] & pageClip(y8,v0,v1) : 0;
+    }
+    byte c[SCR_PAGES];
+    for(uint8_t i=x; i<x1; i++) {
+      for(uint8_t y8=0; y8<scrHt; y8++) c[y8] = scr[y8*scrWd+i];
+      for(uint8_t y8=y8s; y8<=y8e; y8++) {
+        byte m = mr[y8], v = mv[y8];
+        int16_t yy = y8*8-sy;
+        byte b = (columnBits(c,scrHt,yy) & v) | (m & ~v & (wrap ? columnBits(c,scrHt,yy+h) : fb));
+        scr[y8*scrWd+i] = (c[y8] & ~m) | b;
+      }
+    }
+  }
+}
+
 // ----------------------------------------------------------------
 // text rendering
 // ----------------------------------------------------------------
+// packed font: 0, xSize, ySize, firstCh, lastCh, 16-bit offsets of all glyphs and end of data,
+// glyphs: width and columns of ySize bits each, LSB first, without padding between columns
+#define fontword(x) (fontbyte(x) | fontbyte((x)+1)<<8)
+
 void ST7567_FB::setFont(const uint8_t* font)
 {
   cfont.font = font;
-  cfont.xSize = fontbyte(0);
-  cfont.ySize = fontbyte(1);
-  cfont.firstCh = fontbyte(2);
-  cfont.lastCh  = fontbyte(3);
+  cfont.packed = fontbyte(0)==0;
+  cfont.xSize = fontbyte(cfont.packed+0);
+  cfont.ySize = fontbyte(cfont.packed+1);
+  cfont.firstCh = fontbyte(cfont.packed+2);
+  cfont.lastCh  = fontbyte(cfont.packed+3);
   cfont.minDigitWd = 0;
   cfont.minCharWd = 0;
   isNumberFun = &isNumber;
   spacing = 1;
   cr = 0;
   invertCh = 0;
+  opaque = 0;
+#ifdef USE_FONT_INDEX
+  // widths and offsets of glyph data, so measuring and drawing don't need multiplications and PROGMEM reads
+  int fwd = cfont.xSize<0 ? -cfont.xSize : cfont.xSize;
+  int step = fwd*((cfont.ySize+7)/8)+1;
+  int n = cfont.lastCh-cfont.firstCh+1;
+  if(n>FONT_INDEX_MAX) n = FONT_INDEX_MAX;
+  for(int i=0, ofs=4; i<n; i++, ofs+=step) {
+    if(cfont.packed) ofs = fontword(5+2*i);
+    fontWd[i] = fontbyte(ofs);
+    fontOfs[i] = ofs+1;
+  }
+  fontIdxCnt = n;
+#endif
 }
 // ----------------------------------------------------------------
 int ST7567_FB::fontHeight()
@@ -751,25 +1875,52 @@ int ST7567_FB::fontHeight()
   return cfont.ySize;
 }
 // ----------------------------------------------------------------
+// packed fonts start with 0, so header is 1 byte later
+uint8_t ST7567_FB::fontHeight(const uint8_t *font)
+{
+  return pgm_read_byte(font+(pgm_read_byte(font)==0)+1);
+}
+// ----------------------------------------------------------------
+// glyph width, spacing before and behind it, returns offset of glyph column data
+// c must be already converted and in font range
+int ST7567_FB::glyphMetrics(uint8_t c, int *wd, int *wdL, int *wdR)
+{
+  int ofs;
+  c -= cfont.firstCh;
+#ifdef USE_FONT_INDEX
+  if(c<fontIdxCnt) {
+    ofs = fontOfs[c];
+    *wd = fontWd[c];
+  } else
+#endif
+  {
+    int fwd = cfont.xSize<0 ? -cfont.xSize : cfont.xSize;
+    ofs = cfont.packed ? fontword(5+2*c) : c * (fwd*((cfont.ySize+7)/8)+1) + 4;
+    *wd = fontbyte(ofs++);
+  }
+  c += cfont.firstCh;
+  *wdL = 0; *wdR = spacing; // default spacing before and behind char
+  if((*isNumberFun)(c) && cfont.minDigitWd>0) {
+    if(cfont.minDigitWd>*wd) {
+      *wdL  = (cfont.minDigitWd-*wd)/2;
+      *wdR += (cfont.minDigitWd-*wd-*wdL);
+    }
+  } else if(cfont.minCharWd>*wd) {
+    *wdL  = (cfont.minCharWd-*wd)/2;
+    *wdR += (cfont.minCharWd-*wd-*wdL);
+  }
+  return ofs;
+}
+// ----------------------------------------------------------------
 int ST7567_FB::charWidth(uint8_t c, bool last)
 {
   c = convertPolish(c);
+  int fwd = cfont.xSize<0 ? -cfont.xSize : cfont.xSize;
   if(c < cfont.firstCh || c > cfont.lastCh)
-    return c==' ' ?  1 + cfont.xSize/2 : 0;
+    return c==' ' ?  1 + fwd/2 : 0;
   if (cfont.xSize > 0) return cfont.xSize;
-  int ys8=(cfont.ySize+7)/8;
-  int idx = 4 + (c-cfont.firstCh)*(-cfont.xSize*ys8+1);
-  int wd = pgm_read_byte(cfont.font + idx);
-  int wdL = 0, wdR = spacing; // default spacing before and behind char
-  if((*isNumberFun)(c) && cfont.minDigitWd>0) {
-    if(cfont.minDigitWd>wd) {
-      wdL = (cfont.minDigitWd-wd)/2;
-      wdR += (cfont.minDigitWd-wd-wdL);
-    }
-  } else if(cfont.minCharWd>wd) {
-    wdL = (cfont.minCharWd-wd)/2;
-    wdR += (cfont.minCharWd-wd-wdL);
-  }
+  int wd, wdL, wdR;
+  glyphMetrics(c,&wd,&wdL,&wdR);
   return last ? wd+wdL+wdR : wd+wdL+wdR-spacing;  // last!=0 -> get rid of last empty columns 
 }
 // ----------------------------------------------------------------
@@ -782,69 +1933,144 @@ int ST7567_FB::strWidth(char *str)
 // ----------------------------------------------------------------
 int ST7567_FB::printChar(int xpos, int ypos, unsigned char c)
 {
-  if(xpos >= SCR_WD || ypos >= SCR_HT)  return 0;
+  STAT_CALL(STAT_TEXT);
+#ifdef USE_PAGE_MODE
+  if(dlMode==DL_REC) { // drawn later by display(), only width is calculated now
+    dlPut(OP_CHAR,"wwTb",xpos,ypos,c);
+    dlMode = DL_SKIP;
+    int wd = printChar(xpos,ypos,c);
+    dlMode = DL_REC;
+    return wd;
+  }
+#endif
+  if(xpos >= scrWd || ypos >= scrHtPx)  return 0;
   int fht8 = (cfont.ySize + 7) / 8, wd, fwd = cfont.xSize;
   if(fwd < 0)  fwd = -fwd;
 
   c = convertPolish(c);
-  if(c < cfont.firstCh || c > cfont.lastCh)  return c==' ' ?  1 + fwd/2 : 0;
+  if(c < cfont.firstCh || c > cfont.lastCh) {
+    if(c!=' ') return 0;
+    if(opaque) blit(NULL,0,0,xpos,ypos,1+fwd/2,cfont.ySize,COPY,NULL);
+    return 1 + fwd/2;
+  }
 
-  int x,y8,b,cdata = (c - cfont.firstCh) * (fwd*fht8+1) + 4;
-  byte d;
-  wd = fontbyte(cdata++);
-  int wdL = 0, wdR = spacing;
-  if((*isNumberFun)(c) && cfont.minDigitWd>0) {
-    if(cfont.minDigitWd>wd) {
-      wdL  = (cfont.minDigitWd-wd)/2;
-      wdR += (cfont.minDigitWd-wd-wdL);
-    }
-  } else if(cfont.minCharWd>wd) {
-    wdL  = (cfont.minCharWd-wd)/2;
-    wdR += (cfont.minCharWd-wd-wdL);
-  }
-  if(xpos+wd+wdL+wdR>SCR_WD) wdR = max(SCR_WD-xpos-wdL-wd, 0);
-  if(xpos+wd+wdL+wdR>SCR_WD) wd  = max(SCR_WD-xpos-wdL, 0);
-  if(xpos+wd+wdL+wdR>SCR_WD) wdL = max(SCR_WD-xpos, 0);
-
-  for(x=0; x<wd; x++) {
-    //byte mask = 1 << ((xpos+x+wdL)&7);
-    for(y8=0; y8<fht8; y8++) {
-      d = fontbyte(cdata+x*fht8+y8);
-      int lastbit = cfont.ySize - y8 * 8;
-      if (lastbit > 8) lastbit = 8;
-      for(b=0; b<lastbit; b++) {
-         if(d & 1) scr[((ypos+y8*8+b)/8)*scrWd+xpos+x+wdL] |= 1<<((ypos+y8*8+b)&7);  //drawPixel(xpos+x+wdL, ypos+y8*8+b, 1);
-         d>>=1;
-      }
+  int wdL, wdR;
+  int cdata = glyphMetrics(c,&wd,&wdL,&wdR);
+  int gwd = wd;
+  if(xpos+wd+wdL+wdR>scrWd) wdR = max(scrWd-xpos-wdL-wd, 0);
+  if(xpos+wd+wdL+wdR>scrWd) wd  = max(scrWd-xpos-wdL, 0);
+  if(xpos+wd+wdL+wdR>scrWd) wdL = max(scrWd-xpos, 0);
+
+  // glyph columns are blitted as whole bytes, opaque mode clears background and padding in the same pass
+  if(opaque) blit(NULL,0,0,xpos,ypos,wdL,cfont.ySize,COPY,NULL);
+  if(cfont.packed) blitPacked(c,cdata,gwd,xpos+wdL,ypos,wd,opaque ? COPY : SET);
+  else blit(cfont.font+cdata,fht8,1,xpos+wdL,ypos,wd,cfont.ySize,opaque ? COPY : SET,NULL);
+  if(opaque) blit(NULL,0,0,xpos+wdL+wd,ypos,wdR,cfont.ySize,COPY,NULL);
+  return wd+wdR+wdL;
+}
+// ----------------------------------------------------------------
+// columns i0..i0+n-1 of packed glyph are unpacked to buf in regular font layout (ht8 bytes per column)
+void ST7567_FB::unpackGlyph(int ofs, uint8_t i0, uint8_t n, byte *buf)
+{
+  uint8_t fht8 = (cfont.ySize+7)/8;
+  uint16_t p = i0*cfont.ySize;  // bit position in glyph data
+  for(; n; n--) {
+    uint8_t left = cfont.ySize;
+    for(uint8_t j=0; j<fht8; j++) {
+      uint8_t bits = left<8 ? left : 8, sh = p&7;
+      const uint8_t *s = cfont.font+ofs+(p>>3);
+      byte v = pgm_read_byte(s)>>sh;
+      if(sh+bits>8) v |= pgm_read_byte(s+1)<<(8-sh);
+      *buf++ = v & (0xff>>(8-bits));
+      p += bits;
+      left -= bits;
     }
   }
-  return wd+wdR+wdL;
+}
+// ----------------------------------------------------------------
+// gwd - width of whole glyph, wd - visible columns
+void ST7567_FB::blitPacked(uint8_t c, int ofs, uint8_t gwd, int16_t x, int16_t y, uint8_t wd, uint8_t rop)
+{
+#ifdef USE_PAGE_MODE
+  if(dlMode>=DL_REC) return;
+#endif
+  uint8_t fht8 = (cfont.ySize+7)/8;
+#ifdef USE_FONT_CACHE
+  byte *g = cachedGlyph(c,ofs,gwd);
+  if(g) { blit(g,fht8,1,x,y,wd,cfont.ySize,rop|SRC_RAM,NULL); return; }
+#endif
+  // visible columns are unpacked in chunks, font height up to 64
+  byte buf[32];
+  int16_t i = x<clipX0 ? clipX0-x : 0, e = x+wd>clipX1 ? clipX1-x : wd;
+  uint8_t n = 32/fht8;
+  for(; i<e; i+=n) {
+    if(n>e-i) n = e-i;
+    unpackGlyph(ofs,i,n,buf);
+    blit(buf,fht8,1,x+i,y,n,cfont.ySize,rop|SRC_RAM,NULL);
+  }
+}
+// ----------------------------------------------------------------
+// least recently used slot is replaced, slots of all fonts are shared
+byte *ST7567_FB::cachedGlyph(uint8_t c, int ofs, uint8_t wd)
+{
+#ifdef USE_FONT_CACHE
+  if(wd*((cfont.ySize+7)/8)>FONT_CACHE_BYTES) return NULL;
+  uint8_t i, lru = 0;
+  cacheTick++;
+  for(i=0; i<FONT_CACHE_GLYPHS; i++) {
+    if(fontCache[i].font==cfont.font && fontCache[i].ch==c) break;
+    if(!fontCache[lru].font) continue;
+    if(!fontCache[i].font || (uint16_t)(cacheTick-fontCache[i].used)>(uint16_t)(cacheTick-fontCache[lru].used)) lru = i;
+  }
+  if(i==FONT_CACHE_GLYPHS) {
+    i = lru;
+    fontCache[i].font = cfont.font;
+    fontCache[i].ch = c;
+    unpackGlyph(ofs,0,wd,fontCache[i].data);
+  }
+  fontCache[i].used = cacheTick;
+  return fontCache[i].data;
+#else
+  return NULL;
+#endif
 }
 // ----------------------------------------------------------------
 int ST7567_FB::printStr(int xpos, int ypos, char *str)
 {
-  unsigned char ch;
-  int stl, row;
+  STAT_CALL(STAT_TEXT);
+#ifdef USE_PAGE_MODE
+  if(dlMode==DL_REC) { // string is copied to the list, end position is calculated now
+    dlPut(OP_STR,"wwTs",xpos,ypos,str);
+    dlMode = DL_SKIP;
+    int x = printStr(xpos,ypos,str);
+    dlMode = DL_REC;
+    return x;
+  }
+#endif
   int x = xpos;
   int y = ypos;
-  int wd = strWidth(str);
 
-  if(x==-1) // right = -1
-    x = SCR_WD - wd;
-  else if(x<0) // center = -2
-    x = (SCR_WD - wd) / 2;
-  if(x<0) x = 0; // left
+  if(x<0) { // width is needed only for alignment
+    int wd = strWidth(str);
+    if(x==-1) // right = -1
+      x = scrWd - wd;
+    else // center = -2
+      x = (scrWd - wd) / 2;
+    if(x<0) x = 0; // left
+  }
+  xpos = x;
 
   while(*str) {
     int wd = printChar(x,y,*str++);
     x+=wd;
-    if(cr && x>=SCR_WD) { 
+    if(cr && x>=scrWd) { 
       x=0; 
       y+=cfont.ySize; 
-      if(y>SCR_HT) y = 0;
+      if(y>scrHtPx) y = 0;
     }
   }
-  if(invertCh) fillRect(xpos,x-1,y,y+cfont.ySize+1,2);
+  if(invertCh) fillRect(xpos,y,x-xpos,cfont.ySize,2);
+
   return x;
 }
 // ----------------------------------------------------------------
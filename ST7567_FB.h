@@ -20,14 +20,33 @@
 // ------------
 // remove define for software SPI
 #define USE_HW_SPI
+// remove define to disable tracking of changed columns per page (saves 16B of RAM)
+#define USE_DIRTY_TRACKING
+// add define for 2nd buffer with copy of LCD RAM for displayDiff() (uses 1KB of RAM)
+//#define USE_SHADOW_BUF
+// add define for RAM table of glyph widths and data offsets built in setFont() (3 bytes per glyph)
+//#define USE_FONT_INDEX
+#define FONT_INDEX_MAX 96  // only first glyphs are indexed, the rest is read from font data
+// add define for RAM cache of glyphs decoded from packed fonts, FONT_CACHE_GLYPHS*(FONT_CACHE_BYTES+5) bytes
+//#define USE_FONT_CACHE
+#define FONT_CACHE_GLYPHS 8
+#define FONT_CACHE_BYTES 24  // max wd*ht8 of cached glyph, bigger ones are decoded column by column
+// add define for page mode, drawing calls are recorded and replayed page by page into 1 page band by display()
+//#define USE_PAGE_MODE
+// remove define when all objects get buffers from setBuffer() or use only page mode (saves 1KB of RAM)
+#define USE_STATIC_BUF
+// add define for performance counters in stats (about 100 bytes of RAM), nothing is compiled without it
+//#define USE_STATS
 // ------------
 
 #include <Arduino.h>
 #include <avr/pgmspace.h>
+#include "ST7567_Transport.h"
 
 #define SCR_WD  128
 #define SCR_HT  64
 #define SCR_HT8 8  // SCR_HT/8
+#define SCR_PAGES 16  // max pages of frame buffer, portrait rotation has 16 pages of 64 columns
 
 #define ALIGN_LEFT    0
 #define ALIGN_RIGHT  -1 
@@ -36,6 +55,31 @@
 #define SET 1
 #define CLR 0
 #define XOR 2
+#define COPY 3  // bitmaps only, overwrites background
+#define SRC_RAM 0x80  // blit() flag, source data is in RAM (mask is always in PROGMEM)
+
+#define POLY_MAX_PTS 16  // max vertices of fillPolygon(), each needs 14 bytes of stack, bigger polygons are not drawn
+
+#ifdef USE_STATS
+// drawing calls are counted only at top level (lines of rectangle or chars of string are not counted)
+enum { STAT_PIXEL, STAT_LINE, STAT_RECT, STAT_FILL, STAT_CIRCLE, STAT_TRIANGLE, STAT_POLYGON, STAT_BITMAP, STAT_TEXT, STAT_SCROLL, STAT_PRIMS };
+
+struct ST7567_Stats
+{
+  uint32_t dataBytes;
+  uint32_t cmdBytes;
+  uint32_t csCnt;          // CS windows
+  uint32_t flushes;        // display(), displayDirty(), displayDiff() and copy(), flushStep() chunks only send bytes
+  uint32_t flushUs;        // last flush time
+  uint32_t flushUsMax;
+  uint32_t flushUsSum;
+  uint32_t calls[STAT_PRIMS];
+  uint32_t bytes[STAT_PRIMS];  // frame buffer bytes marked as changed, overlapping marks are counted again
+  uint8_t cur;             // primitive being drawn, STAT_PRIMS - none
+  bool flushing;
+  uint32_t flushUsAvg() { return flushes ? flushUsSum/flushes : 0; }
+};
+#endif
 
 struct _propFont
 {
@@ -46,6 +90,7 @@ struct _propFont
   uint8_t lastCh;
   uint8_t minCharWd;
   uint8_t minDigitWd;
+  uint8_t packed;  // font converted by extras/fontpack.py
 };
 
 // ---------------------------------
@@ -53,28 +98,68 @@ class ST7567_FB {
 public:
   ST7567_FB(uint8_t dc, uint8_t rst, uint8_t cs);
   ST7567_FB(uint8_t dc, uint8_t rst, uint8_t cs, uint8_t sdi, uint8_t clk);
+  ST7567_FB(ST7567_Transport *t, uint8_t rst=255);
+  ~ST7567_FB() { delete defBus; }
 
-  inline void sendSPI(uint8_t v) __attribute__((always_inline)); // costs about 350B of flash
+  void setTransport(ST7567_Transport *t) { bus = t; }
+  inline void sendSPI(uint8_t v) __attribute__((always_inline));
   inline void sendCmd(uint8_t cmd);
   inline void sendData(uint8_t data);
   void init(int contrast=7);
   void begin() { init(); }
   void initCmds();
   void display();
+  void displayDirty();
+  void displayDiff();
+  void beginFlush(bool dirtyOnly=false);
+  // in portrait each chunk is a run of 8x8 tiles of one LCD page, at least one tile (8 bytes) per call
+  bool flushStep(uint16_t maxBytes=32);
+  bool flushDone() { return flushY8>=scrHt; }
+
   void copy(uint8_t x, uint8_t y8, uint8_t wd, uint8_t ht8);
+  // commands are queued and sent by sendCmds() in one burst with DC low, CS stays active for data
+  void queueCmd(uint8_t cmd) { if(cmdLen>=sizeof(cmdBuf)) sendCmds(); cmdBuf[cmdLen++] = cmd; }
+  void sendCmds();
   void gotoXY(byte x, byte y);
+  void writePage(uint8_t x, uint8_t y8, const byte *buf, uint8_t n);  // address and data in one CS window
+  void writeFrame(const byte *buf);
+  void writeTiles(const byte *buf, uint8_t lx0, uint8_t lx1, uint8_t lp0, uint8_t lp1);
+  static void transpose8(const byte *in, byte *out);
   void sleep(bool mode=true);
   void setContrast(byte val);
   void setScroll(byte val);
   void displayInvert(bool mode);
   void displayOn(bool mode);
   void displayMode(byte val);
-  void setRotation(int mode);
+  void setRotation(int mode);  // 1 and 3 - portrait 64x128, frame buffer is transposed when sent
+  // own frame buffer (wd*((ht+7)/8) bytes, max 128x64 or 64x128 in portrait) for 2nd display or smaller panel
+  // each object with USE_SHADOW_BUF needs own shadow buffer too, built-in one is shared
+  void setBuffer(byte *buf, uint8_t wd=SCR_WD, uint8_t ht=SCR_HT, byte *shadowBuf=NULL);
+  uint8_t xOfs() { return (rotation&2) ? 132-((rotation&1) ? scrHtPx : scrWd) : 0; }  // 1st LCD RAM column, ST7567 has 132 columns
+  void setClip(uint8_t x, uint8_t y, uint8_t w, uint8_t h);
+  void resetClip() { setClip(0,0,scrWd,scrHtPx); }
+#ifdef USE_PAGE_MODE
+  // band has scrWd bytes, list keeps drawing calls since last cls()
+  // copy(), displayDirty(), displayDiff() and flush steps send whole frame in page mode
+  void beginPageMode(byte *band, byte *list, uint16_t listSize);
+  void endPageMode();
+  void dlPut(uint8_t op, const char *fmt, ...);
+  void dlReplay();
+  void dlText(const byte *&p);
+#endif
+  void setDirty();
+  void clearDirty();
+#ifdef USE_DIRTY_TRACKING
+  void dirtyTiles(uint8_t p, uint8_t &lp0, uint8_t &lp1);
+#endif
+  inline void markDirty(uint8_t x0, uint8_t x1, uint8_t y8s, uint8_t y8e);
 
   void cls();
   void clearDisplay() { cls(); }
   void drawPixel(uint8_t x, uint8_t y, uint8_t col);
-  void drawLine(int8_t x0, int8_t y0, int8_t x1, int8_t y1, uint8_t col);
+  void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t col);
+  void drawLineD(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t col);
+  void drawLineKernel(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t col, bool dither);
   void drawLineH(uint8_t x0, uint8_t x1, uint8_t y, uint8_t col);
   void drawLineV(uint8_t x,  uint8_t y0, uint8_t y1, uint8_t col);
   void drawLineVfast(uint8_t x, uint8_t y0, uint8_t y1, uint8_t col);
@@ -85,26 +170,48 @@ public:
   void drawRectD(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t col);
   void fillRect(uint8_t x0, uint8_t y0, uint8_t w, uint8_t h, uint8_t col);
   void fillRectD(uint8_t x0, uint8_t y0, uint8_t w, uint8_t h, uint8_t col);
+  void fillRectKernel(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t col, bool dither);
+
   void drawCircle(uint8_t x0, uint8_t y0, uint8_t radius, uint8_t col);
   void fillCircle(uint8_t x0, uint8_t y0, uint8_t r, uint8_t col);
   void fillCircleD(uint8_t x0, uint8_t y0, uint8_t r, uint8_t col);
   void drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
   void fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
   void fillTriangleD(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
+  // pts: x0,y0, x1,y1, ... coordinates -8192..8191, even-odd rule, pixel is filled when its center is inside
+  // pts - n x,y pairs, n>POLY_MAX_PTS draws nothing, use fillTriangle() for triangles (faster, edges inclusive)
+  void fillPolygon(const int16_t *pts, uint8_t n, uint8_t col);
+  void fillPolygonD(const int16_t *pts, uint8_t n, uint8_t col);
+  void fillPolygonKernel(const int16_t *pts, uint8_t n, uint8_t col, bool dither);
   void setDither(int8_t s);
   int drawBitmap(const uint8_t *bmp, int x, uint8_t y, uint8_t w, uint8_t h);
   int drawBitmap(const uint8_t *bmp, int x, uint8_t y);
+  int blitBitmap(const uint8_t *bmp, int16_t x, int16_t y, uint8_t rop=SET, const uint8_t *mask=NULL);
+  int blitBitmap(const uint8_t *bmp, int16_t x, int16_t y, uint8_t w, uint8_t h, uint8_t rop, const uint8_t *mask=NULL);
+  void blit(const uint8_t *src, uint8_t colStep, uint8_t rowStep, int16_t x, int16_t y, uint8_t w, uint8_t h, uint8_t rop, const uint8_t *mask);
+  // compressed bitmaps, see drawBitmapRLE()
+  int drawBitmapRLE(const uint8_t *bmp, int x, uint8_t y);
+  int blitBitmapRLE(const uint8_t *bmp, int16_t x, int16_t y, uint8_t rop=SET);
+  void blitRLE(const uint8_t *bmp, int16_t x, int16_t y, uint8_t rop);
+  void scrollRegion(uint8_t x, uint8_t y, uint8_t w, uint8_t h, int8_t dx, int8_t dy, int8_t fill=0);  // fill=-1 wraps around
+
 
   void setFont(const uint8_t* f);
   void setCR(uint8_t _cr) { cr = _cr; }
   void setInvert(uint8_t _inv) { invertCh = _inv; }
+  void setOpaque(uint8_t _op) { opaque = _op; }  // text overwrites background, no need to clear it before
   void setFontMinWd(uint8_t wd) { cfont.minCharWd = wd; }
   void setCharMinWd(uint8_t wd) { cfont.minCharWd = wd; }
   void setDigitMinWd(uint8_t wd) { cfont.minDigitWd = wd; }
   int printChar(int xpos, int ypos, unsigned char c);
   int printStr(int xpos, int ypos, char *str);
   int charWidth(uint8_t _ch, bool last=true);
+  int glyphMetrics(uint8_t c, int *wd, int *wdL, int *wdR);
+  void unpackGlyph(int ofs, uint8_t i0, uint8_t n, byte *buf);
+  void blitPacked(uint8_t c, int ofs, uint8_t gwd, int16_t x, int16_t y, uint8_t wd, uint8_t rop);
+  byte *cachedGlyph(uint8_t c, int ofs, uint8_t wd);
   int fontHeight();
+  static uint8_t fontHeight(const uint8_t *font);  // any font, not only current one
   int strWidth(char *txt);
   unsigned char convertPolish(unsigned char _c);
   static bool isNumber(uint8_t ch);
@@ -112,16 +219,64 @@ public:
   void setIsNumberFun(bool (*fun)(uint8_t)) { isNumberFun=fun; }
   
 public:
-  static byte scr[SCR_WD*SCR_HT8];
+#ifdef USE_STATIC_BUF
+  static byte fbuf[SCR_WD*SCR_HT8];
+  byte *scr = fbuf;
+#else
+  byte *scr = NULL;
+#endif
+#ifdef USE_DIRTY_TRACKING
+  byte dirtyMin[SCR_PAGES];  // first changed column in each page, clean page when dirtyMin>dirtyMax
+  byte dirtyMax[SCR_PAGES];  // last changed column in each page
+#endif
+#ifdef USE_SHADOW_BUF
+  static byte shadowBuf[SCR_WD*SCR_HT8];
+  byte *shadow = shadowBuf;  // what LCD RAM currently holds
+  bool shadowValid;
+  uint16_t bytesSaved;  // SPI bytes saved by last displayDiff() vs display()
+#endif
+  // incremental flush state
+  uint8_t flushY8 = 0xff;  // page being sent, scrHt or more when finished
+  uint8_t flushX, flushXe;    // next and last column to send in current page
+  bool flushAll;
+#ifdef USE_DIRTY_TRACKING
+  byte flushLp0[SCR_HT8], flushLp1[SCR_HT8];  // portrait: dirty logical pages for each LCD page, taken by beginFlush()
+#endif
+
+
   byte scrWd = SCR_WD;
-  byte scrHt = SCR_HT8;
+  byte scrHt = SCR_HT8;  // in pages
+  byte scrHtPx = SCR_HT;
+  // drawing is limited to clipX0..clipX1-1, clipY0..clipY1-1
+  uint8_t clipX0 = 0, clipY0 = 0, clipX1 = SCR_WD, clipY1 = SCR_HT;
+#ifdef USE_PAGE_MODE
+  byte *dlBuf, *dlBand, *dlFb;
+  uint16_t dlSize, dlLen;
+  uint8_t dlMode = 0;  // DL_OFF, DL_PLAY, DL_REC, DL_SKIP
+  uint8_t dlY8;        // page being replayed
+  bool dlOverflow;     // list was too small, some calls are missing
+#endif
+#ifdef USE_STATS
+  ST7567_Stats stats;
+  void resetStats();
+#endif
+  uint8_t cmdBuf[12], cmdLen = 0;
+  byte tileBuf[2][8];  // transposed tiles being sent in portrait
+  uint8_t tileIdx = 0;
   uint8_t dcPin, csPin, rstPin;
   uint8_t sdiPin, clkPin;
-  int8_t rotation;
+  int8_t rotation = 0;
+#ifdef USE_HW_SPI
+  ST7567_HWSPI *defBus = NULL;  // only when created by pin based constructor
+#else
+  ST7567_SWSPI *defBus = NULL;
+#endif
+  ST7567_Transport *bus;
+
 
   static byte ystab[8];
   static byte yetab[8];
-  static byte pattern[4];
+  byte pattern[4] = {0xaa,0x55,0xaa,0x55};
   static const byte ditherTab[4*17];
 
 //private:
@@ -130,7 +285,38 @@ public:
   uint8_t cr;  // carriage return mode for printStr
   uint8_t dualChar;
   uint8_t invertCh;
+  uint8_t opaque;
+#ifdef USE_FONT_INDEX
+  uint8_t fontWd[FONT_INDEX_MAX];
+  uint16_t fontOfs[FONT_INDEX_MAX];
+  uint8_t fontIdxCnt;
+#endif
+#ifdef USE_FONT_CACHE
+  struct {
+    const uint8_t *font;  // NULL - empty slot
+    uint8_t ch;
+    uint16_t used;
+    byte data[FONT_CACHE_BYTES];
+  } fontCache[FONT_CACHE_GLYPHS];
+  uint16_t cacheTick;
+#endif
+
+
   uint8_t spacing = 1;	
 };
+// ----------------------------------------------------------------
+// called by all drawing primitives, y8s..y8e must be valid page numbers
+inline void ST7567_FB::markDirty(uint8_t x0, uint8_t x1, uint8_t y8s, uint8_t y8e)
+{
+#ifdef USE_STATS
+  if(stats.cur<STAT_PRIMS) stats.bytes[stats.cur] += (x1-x0+1)*(y8e-y8s+1);
+#endif
+#ifdef USE_DIRTY_TRACKING
+  for(; y8s<=y8e; y8s++) {
+    if(x0<dirtyMin[y8s]) dirtyMin[y8s]=x0;
+    if(x1>dirtyMax[y8s]) dirtyMax[y8s]=x1;
+  }
+#endif
+}
 #endif
 
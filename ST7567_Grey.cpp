@@ -0,0 +1,121 @@
+// Greyscale by temporal bitplanes for ST7567_FB library
+// (C) 2020 by Pawel A. Hernik
+
+#include "ST7567_Grey.h"
+
+// ----------------------------------------------------------------
+ST7567_Grey::ST7567_Grey(ST7567_FB &_lcd, byte *plane1, byte *plane2)
+  : lcd(_lcd)
+{
+  plane[0] = lcd.scr;
+  plane[1] = plane1;
+  plane[2] = plane2;
+  n = plane2 ? 3 : 2;
+  slotUs = 2500;
+  cur = 0;
+  resetStats();
+}
+// ----------------------------------------------------------------
+void ST7567_Grey::cls(uint8_t lev)
+{
+  for(uint8_t i=0; i<n; i++) memset(plane[i],(lev>>i)&1 ? 0xff : 0,lcd.scrWd*lcd.scrHt);
+}
+// ----------------------------------------------------------------
+void ST7567_Grey::drawPixel(uint8_t x, uint8_t y, uint8_t lev)
+{
+  for(uint8_t i=0; i<n; i++) { select(i); lcd.drawPixel(x,y,(lev>>i)&1); }
+  select(0);
+}
+// ----------------------------------------------------------------
+void ST7567_Grey::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t lev)
+{
+  for(uint8_t i=0; i<n; i++) { select(i); lcd.drawLine(x0,y0,x1,y1,(lev>>i)&1); }
+  select(0);
+}
+// ----------------------------------------------------------------
+void ST7567_Grey::fillRect(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t lev)
+{
+  for(uint8_t i=0; i<n; i++) { select(i); lcd.fillRect(x,y,w,h,(lev>>i)&1); }
+  select(0);
+}
+// ----------------------------------------------------------------
+void ST7567_Grey::fillCircle(uint8_t x0, uint8_t y0, uint8_t r, uint8_t lev)
+{
+  for(uint8_t i=0; i<n; i++) { select(i); lcd.fillCircle(x0,y0,r,(lev>>i)&1); }
+  select(0);
+}
+// ----------------------------------------------------------------
+// text box gets bg level, glyphs lev level
+// planes with the same bits are filled, others use opaque text, inverted when glyph bit is 0
+int ST7567_Grey::printStr(int x, int y, char *str, uint8_t lev, uint8_t bg)
+{
+  int wd = lcd.strWidth(str);
+  if(x==ALIGN_RIGHT) x = lcd.scrWd-wd;
+  else if(x==ALIGN_CENTER) x = (lcd.scrWd-wd)/2;
+  if(x<0) x = 0;
+  uint8_t op = lcd.opaque, inv = lcd.invertCh;
+  int xe = x+wd;
+  for(uint8_t i=0; i<n; i++) {
+    select(i);
+    uint8_t f = (lev>>i)&1, b = (bg>>i)&1;
+    if(f==b) { lcd.fillRect(x,y,wd,lcd.fontHeight(),f); continue; }
+    lcd.setOpaque(1);
+    lcd.setInvert(!f);
+    xe = lcd.printStr(x,y,str);
+  }
+  lcd.setOpaque(op);
+  lcd.setInvert(inv);
+  select(0);
+  return xe;
+}
+// ----------------------------------------------------------------
+// the same as display() but without dirty tracking and shadow copy
+void ST7567_Grey::flushPlane(uint8_t i)
+{
+  uint32_t t = micros();
+  lcd.writeFrame(plane[i]);
+#ifdef USE_SHADOW_BUF
+  lcd.shadowValid = false;
+#endif
+  flushUs = micros()-t;
+  planesSent++;
+}
+// ----------------------------------------------------------------
+void ST7567_Grey::resetStats()
+{
+  planesSent = cycles = dropped = 0;
+  rate = flushUs = lateMax = 0;
+  rateCnt = 0;
+  rateStart = micros();
+}
+// ----------------------------------------------------------------
+void ST7567_Grey::start()
+{
+  cur = 0;
+  resetStats();
+  due = rateStart;
+}
+// ----------------------------------------------------------------
+bool ST7567_Grey::update()
+{
+  uint32_t now = micros();
+  int32_t late = now-due;
+  if(late<0) return false;
+  uint32_t prev = (uint32_t)slotUs<<(cur ? cur-1 : n-1);  // time of plane being shown now
+  if(late>=prev) { dropped++; due = now; }
+  else if(late>lateMax) lateMax = late;
+  due += (uint32_t)slotUs<<cur;
+  flushPlane(cur);
+  if(++cur>=n) {
+    cur = 0;
+    cycles++;
+    rateCnt++;
+    if(now-rateStart>=1000000UL) {
+      rate = (uint32_t)rateCnt*1000000UL/(now-rateStart);
+      rateCnt = 0;
+      rateStart = now;
+    }
+  }
+  return true;
+}
+// ----------------------------------------------------------------
@@ -0,0 +1,57 @@
+// Greyscale by temporal bitplanes for ST7567_FB library
+// (C) 2020 by Pawel A. Hernik
+
+/*
+ 2 or 3 bitplanes are shown one after another, plane i is kept on the glass 2^i times longer than plane 0,
+ so pixel level 0..3 or 0..7 becomes average intensity. Plane 0 is the frame buffer of lcd object,
+ other planes (scrWd*scrHt bytes each) are given by the caller, 3 planes need 3KB of RAM together.
+ update() must be called from loop() as often as possible, each plane is sent as full 1KB frame
+ when its time comes. Deadlines are absolute, so jitter doesn't accumulate, when plane is late
+ more than one slot it is counted as dropped and the schedule starts again from now.
+ Works on frame buffer only, not in page mode.
+*/
+
+#ifndef _ST7567_GREY_H
+#define _ST7567_GREY_H
+
+#include "ST7567_FB.h"
+
+#define GREY_PLANES 3  // max number of planes
+
+// ---------------------------------
+class ST7567_Grey {
+public:
+  ST7567_Grey(ST7567_FB &_lcd, byte *plane1, byte *plane2=NULL);
+  uint8_t levels() { return 1<<n; }
+  // regular drawing functions can be used for single plane, select(0) restores lcd frame buffer
+  void select(uint8_t i) { lcd.scr = plane[i]; }
+  void cls(uint8_t lev=0);
+  void drawPixel(uint8_t x, uint8_t y, uint8_t lev);
+  void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t lev);
+  void fillRect(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t lev);
+  void fillCircle(uint8_t x0, uint8_t y0, uint8_t r, uint8_t lev);
+  int printStr(int x, int y, char *str, uint8_t lev, uint8_t bg=0);  // always opaque
+
+  void setSlot(uint16_t us) { slotUs = us; }  // time of plane 0, at least plane transfer time
+  void start();
+  bool update();  // returns true when plane was sent
+  void flushPlane(uint8_t i);
+  void resetStats();
+
+  // statistics
+  uint32_t planesSent;
+  uint32_t cycles;    // full greyscale frames
+  uint32_t dropped;   // planes shown at least twice as long as they should
+  uint16_t rate;      // greyscale frames per second, measured every second
+  uint32_t flushUs;   // last plane transfer time
+  uint32_t lateMax;   // max delay of plane not counted as dropped
+
+  ST7567_FB &lcd;
+  byte *plane[GREY_PLANES];
+  uint8_t n, cur;
+  uint16_t slotUs;
+  uint32_t due, rateStart;
+  uint16_t rateCnt;
+};
+
+#endif
@@ -0,0 +1,209 @@
+// Retained scene objects for ST7567_FB library
+// (C) 2020 by Pawel A. Hernik
+
+#include "ST7567_Scene.h"
+
+// ----------------------------------------------------------------
+ST7567_Object::ST7567_Object(int16_t _x, int16_t _y, uint8_t _w, uint8_t _h)
+{
+  x = ox = _x;
+  y = oy = _y;
+  w = ow = _w;
+  h = oh = _h;
+  changed = visible = true;
+  next = NULL;
+}
+// ----------------------------------------------------------------
+ST7567_Text::ST7567_Text(int16_t x, int16_t y, uint8_t w, const uint8_t *_font, int8_t _align)
+  : ST7567_Object(x,y,w,ST7567_FB::fontHeight(_font))
+{
+  font = _font;
+  align = _align;
+  txt[0] = 0;
+}
+// ----------------------------------------------------------------
+void ST7567_Text::setText(const char *s)
+{
+  if(!strncmp(txt,s,SCENE_TXT_LEN)) return;
+  strncpy(txt,s,SCENE_TXT_LEN);
+  txt[SCENE_TXT_LEN] = 0;
+  changed = true;
+}
+// ----------------------------------------------------------------
+// setFont() resets text settings, so sketch's font and settings are restored after drawing
+void ST7567_Text::draw(ST7567_FB &lcd)
+{
+  _propFont f = lcd.cfont;
+  uint8_t sp = lcd.spacing, inv = lcd.invertCh, opq = lcd.opaque, crm = lcd.cr;
+  bool (*num)(uint8_t) = lcd.isNumberFun;
+  lcd.setFont(font);
+  int xp = x;
+  if(align!=ALIGN_LEFT) {
+    int wd = lcd.strWidth(txt);
+    xp = align==ALIGN_RIGHT ? x+w-wd : x+(w-wd)/2;
+    if(xp<x) xp = x;
+  }
+  lcd.printStr(xp,y,txt);
+  if(f.font && f.font!=font) lcd.setFont(f.font);
+  lcd.cfont = f;
+  lcd.spacing = sp; lcd.invertCh = inv; lcd.opaque = opq; lcd.cr = crm;
+  lcd.isNumberFun = num;
+}
+// ----------------------------------------------------------------
+ST7567_Bar::ST7567_Bar(int16_t x, int16_t y, uint8_t w, uint8_t h, int16_t _maxVal, bool _vertical)
+  : ST7567_Object(x,y,w,h)
+{
+  maxVal = _maxVal>0 ? _maxVal : 1;
+  vertical = _vertical;
+  val = 0;
+}
+// ----------------------------------------------------------------
+void ST7567_Bar::setValue(int16_t v)
+{
+  if(v<0) v = 0;
+  if(v>maxVal) v = maxVal;
+  if(v==val) return;
+  val = v;
+  changed = true;
+}
+// ----------------------------------------------------------------
+void ST7567_Bar::draw(ST7567_FB &lcd)
+{
+  lcd.drawRect(x,y,w,h,1);
+  if(w<5 || h<5) return;
+  if(vertical) {
+    uint8_t fh = (long)(h-4)*val/maxVal;
+    lcd.fillRect(x+2,y+h-2-fh,w-4,fh,1);
+  } else
+    lcd.fillRect(x+2,y+2,(long)(w-4)*val/maxVal,h-4,1);
+}
+// ----------------------------------------------------------------
+ST7567_Bitmap::ST7567_Bitmap(int16_t x, int16_t y, const uint8_t *_bmp, uint8_t _rop)
+  : ST7567_Object(x,y,pgm_read_byte(_bmp+0),pgm_read_byte(_bmp+1))
+{
+  bmp = _bmp;
+  rop = _rop;
+}
+// ----------------------------------------------------------------
+void ST7567_Bitmap::setBitmap(const uint8_t *_bmp)
+{
+  if(_bmp==bmp) return;
+  bmp = _bmp;
+  w = pgm_read_byte(bmp+0);
+  h = pgm_read_byte(bmp+1);
+  changed = true;
+}
+// ----------------------------------------------------------------
+void ST7567_Bitmap::draw(ST7567_FB &lcd)
+{
+  lcd.blitBitmap(bmp,x,y,rop);
+}
+// ----------------------------------------------------------------
+// 0..90 degrees, 255 = 1.0
+static const uint8_t sinTab[91] PROGMEM = {
+0,4,8,13,17,22,26,31,35,39,44,48,53,57,61,65,70,74,78,83,87,91,95,99,103,107,111,115,119,123,
+127,131,135,138,142,146,149,153,156,160,163,167,170,173,177,180,183,186,189,192,195,198,200,203,206,208,211,213,216,218,
+220,223,225,227,229,231,232,234,236,238,239,241,242,243,245,246,247,248,249,250,251,251,252,253,253,254,254,254,254,254,
+255
+};
+
+static int fastSin(int i)
+{
+  while(i<0) i+=360;
+  while(i>=360) i-=360;
+  if(i<90)  return pgm_read_byte(&sinTab[i]);
+  if(i<180) return pgm_read_byte(&sinTab[180-i]);
+  if(i<270) return -pgm_read_byte(&sinTab[i-180]);
+  return -pgm_read_byte(&sinTab[360-i]);
+}
+// ----------------------------------------------------------------
+ST7567_Gauge::ST7567_Gauge(int16_t cx, int16_t cy, uint8_t _r, int16_t _maxVal)
+  : ST7567_Object(cx-_r,cy-_r,2*_r+1,2*_r+1)
+{
+  r = _r;
+  maxVal = _maxVal>0 ? _maxVal : 1;
+  val = 0;
+}
+// ----------------------------------------------------------------
+void ST7567_Gauge::setValue(int16_t v)
+{
+  if(v<0) v = 0;
+  if(v>maxVal) v = maxVal;
+  if(v==val) return;
+  val = v;
+  changed = true;
+}
+// ----------------------------------------------------------------
+// scale from 225 (0) to -45 degrees (maxVal), 5 ticks
+void ST7567_Gauge::draw(ST7567_FB &lcd)
+{
+  int cx = x+r, cy = y+r;
+  lcd.drawCircle(cx,cy,r,1);
+  for(int a=225; a>=-45; a-=270/4) {
+    int s = fastSin(a), c = fastSin(a+90);
+    lcd.drawLine(cx+c*(r-3)/255,cy-s*(r-3)/255,cx+c*r/255,cy-s*r/255,1);
+  }
+  int a = 225-(long)270*val/maxVal;
+  lcd.drawLine(cx,cy,cx+fastSin(a+90)*(r-4)/255,cy-fastSin(a)*(r-4)/255,1);
+  lcd.fillCircle(cx,cy,2,1);
+}
+// ----------------------------------------------------------------
+void ST7567_Scene::add(ST7567_Object *o)
+{
+  o->next = NULL;
+  if(!first) { first = o; return; }
+  ST7567_Object *last = first;
+  while(last->next) last = last->next;
+  last->next = o;
+}
+// ----------------------------------------------------------------
+// clears the area and draws all visible objects overlapping it, each one clipped to its box
+// everything stays within current clip rectangle, which is restored at the end
+void ST7567_Scene::redrawArea(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+  uint8_t cx0 = lcd.clipX0, cy0 = lcd.clipY0, cx1 = lcd.clipX1, cy1 = lcd.clipY1;
+  if(x<cx0) { w-=cx0-x; x=cx0; }
+  if(y<cy0) { h-=cy0-y; y=cy0; }
+  if(x+w>cx1) w = cx1-x;
+  if(y+h>cy1) h = cy1-y;
+  if(w<=0 || h<=0) return;
+  lcd.setClip(x,y,w,h);
+  lcd.fillRect(x,y,w,h,0);
+  for(ST7567_Object *o=first; o; o=o->next) {
+    if(!o->visible || !o->overlaps(x,y,w,h)) continue;
+    int16_t x0 = max(x,o->x), y0 = max(y,o->y);
+    int16_t x1 = min(x+w,o->x+o->w), y1 = min(y+h,o->y+o->h);
+    lcd.setClip(x0,y0,x1-x0,y1-y0);
+    o->draw(lcd);
+  }
+  lcd.setClip(cx0,cy0,cx1-cx0,cy1-cy0);
+}
+// ----------------------------------------------------------------
+void ST7567_Scene::redrawAll()
+{
+  redrawArea(0,0,lcd.scrWd,lcd.scrHtPx);
+  for(ST7567_Object *o=first; o; o=o->next) {
+    o->changed = false;
+    o->ox = o->x; o->oy = o->y;
+    o->ow = o->w; o->oh = o->h;
+  }
+  lcd.display();
+}
+// ----------------------------------------------------------------
+// old box of moved object is redrawn too, objects below and above are restored
+bool ST7567_Scene::update(bool flush)
+{
+  bool any = false;
+  for(ST7567_Object *o=first; o; o=o->next) {
+    if(!o->changed) continue;
+    o->changed = false;
+    if(o->ox!=o->x || o->oy!=o->y || o->ow!=o->w || o->oh!=o->h) redrawArea(o->ox,o->oy,o->ow,o->oh);
+    redrawArea(o->x,o->y,o->w,o->h);
+    o->ox = o->x; o->oy = o->y;
+    o->ow = o->w; o->oh = o->h;
+    any = true;
+  }
+  if(any && flush) lcd.displayDirty();
+  return any;
+}
+// ----------------------------------------------------------------
@@ -0,0 +1,99 @@
+// Retained scene objects for ST7567_FB library
+// (C) 2020 by Pawel A. Hernik
+
+/*
+ Objects keep their position and value, so the whole frame doesn't have to be rebuilt with cls() every time.
+ update() redraws only the areas of changed objects: area is cleared, all objects overlapping it
+ are drawn again in z-order (clipped to the area) and only modified parts of pages are sent by displayDirty().
+ Redrawing stays within current clip rectangle and keeps it, sketch's font and text settings are kept too.
+ Objects:
+  ST7567_Text   - text field with fixed box, left/right/center aligned
+  ST7567_Bar    - horizontal or vertical bar graph
+  ST7567_Bitmap - bitmap which can be moved or replaced
+  ST7567_Gauge  - 270 degrees gauge with needle
+*/
+
+#ifndef _ST7567_SCENE_H
+#define _ST7567_SCENE_H
+
+#include "ST7567_FB.h"
+
+#define SCENE_TXT_LEN 24  // max text length in ST7567_Text
+
+// ---------------------------------
+class ST7567_Object {
+public:
+  ST7567_Object(int16_t _x, int16_t _y, uint8_t _w, uint8_t _h);
+  virtual void draw(ST7567_FB &lcd) = 0;
+  void invalidate() { changed = true; }
+  void setVisible(bool v) { if(v!=visible) { visible = v; changed = true; } }
+  void moveTo(int16_t _x, int16_t _y) { if(_x!=x || _y!=y) { x = _x; y = _y; changed = true; } }
+  bool overlaps(int16_t rx, int16_t ry, int16_t rw, int16_t rh) { return x<rx+rw && rx<x+w && y<ry+rh && ry<y+h; }
+
+  int16_t x, y;      // bounding box
+  uint8_t w, h;
+  int16_t ox, oy;    // box at last redraw, cleared when object is moved or resized
+  uint8_t ow, oh;
+  bool changed, visible;
+  ST7567_Object *next;
+};
+
+// ---------------------------------
+class ST7567_Text : public ST7567_Object {
+public:
+  ST7567_Text(int16_t x, int16_t y, uint8_t w, const uint8_t *_font, int8_t _align=ALIGN_LEFT);
+  void setText(const char *s);
+  void draw(ST7567_FB &lcd);
+
+  const uint8_t *font;
+  int8_t align;
+  char txt[SCENE_TXT_LEN+1];
+};
+
+// ---------------------------------
+class ST7567_Bar : public ST7567_Object {
+public:
+  ST7567_Bar(int16_t x, int16_t y, uint8_t w, uint8_t h, int16_t _maxVal, bool _vertical=false);
+  void setValue(int16_t v);
+  void draw(ST7567_FB &lcd);
+
+  int16_t val, maxVal;
+  bool vertical;
+};
+
+// ---------------------------------
+class ST7567_Bitmap : public ST7567_Object {
+public:
+  ST7567_Bitmap(int16_t x, int16_t y, const uint8_t *_bmp, uint8_t _rop=SET);
+  void setBitmap(const uint8_t *_bmp);
+  void draw(ST7567_FB &lcd);
+
+  const uint8_t *bmp;  // PROGMEM, width and height in first 2 bytes
+  uint8_t rop;
+};
+
+// ---------------------------------
+class ST7567_Gauge : public ST7567_Object {
+public:
+  ST7567_Gauge(int16_t cx, int16_t cy, uint8_t _r, int16_t _maxVal);
+  void setValue(int16_t v);
+  void draw(ST7567_FB &lcd);
+
+  uint8_t r;
+  int16_t val, maxVal;
+};
+
+// ---------------------------------
+class ST7567_Scene {
+public:
+  ST7567_Scene(ST7567_FB &_lcd) : lcd(_lcd) { first = NULL; }
+  void add(ST7567_Object *o);  // new object is drawn on top of previous ones
+  void redrawAll();
+  bool update(bool flush=true);  // returns true when something was redrawn
+  void redrawArea(int16_t x, int16_t y, int16_t w, int16_t h);
+
+  ST7567_FB &lcd;
+  ST7567_Object *first;
+};
+
+#endif
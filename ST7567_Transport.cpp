@@ -0,0 +1,117 @@
+// Transport layer for ST7567_FB library
+// (C) 2020 by Pawel A. Hernik
+
+#include "ST7567_Transport.h"
+#include <SPI.h>
+
+#ifdef USE_FAST_PINIO
+#define PIN_LOW(p)   *p##Port &= ~p##Mask
+#define PIN_HIGH(p)  *p##Port |= p##Mask
+#define PIN_INIT(p)  p##Port = portOutputRegister(digitalPinToPort(p##Pin)); p##Mask = digitalPinToBitMask(p##Pin)
+#else
+#define PIN_LOW(p)   digitalWrite(p##Pin, LOW)
+#define PIN_HIGH(p)  digitalWrite(p##Pin, HIGH)
+#define PIN_INIT(p)
+#endif
+
+// ----------------------------------------------------------------
+void ST7567_HWSPI::begin()
+{
+  pinMode(csPin, OUTPUT);
+  pinMode(dcPin, OUTPUT);
+  PIN_INIT(cs);
+  PIN_INIT(dc);
+  SPI.begin();
+  SPI.setDataMode(SPI_MODE0);
+#ifdef __AVR__
+  SPI.setClockDivider(SPI_CLOCK_DIV2);
+#endif
+}
+// ----------------------------------------------------------------
+void ST7567_HWSPI::csActive()  { PIN_LOW(cs); }
+void ST7567_HWSPI::csIdle()    { PIN_HIGH(cs); }
+void ST7567_HWSPI::dcCommand() { PIN_LOW(dc); }
+void ST7567_HWSPI::dcData()    { PIN_HIGH(dc); }
+// ----------------------------------------------------------------
+void ST7567_HWSPI::write(uint8_t v)
+{
+  SPI.transfer(v);
+}
+// ----------------------------------------------------------------
+void ST7567_HWSPI::write(const uint8_t *buf, uint16_t n)
+{
+  if(!n) return;
+#if defined(__AVR__)
+  // next byte is fetched while previous one is shifted out
+  SPDR = *buf++;
+  while(--n) {
+    uint8_t v = *buf++;
+    while(!(SPSR & _BV(SPIF)));
+    SPDR = v;
+  }
+  while(!(SPSR & _BV(SPIF)));
+#elif defined(ESP32) || defined(ESP8266)
+  SPI.writeBytes((uint8_t*)buf, n);
+#else
+  // SPI.transfer(buf,n) overwrites the buffer with received data, so send framebuffer via small copy
+  uint8_t tmp[16];
+  while(n) {
+    uint8_t cnt = n>sizeof(tmp) ? sizeof(tmp) : n;
+    memcpy(tmp, buf, cnt);
+    SPI.transfer(tmp, cnt);
+    buf += cnt;
+    n -= cnt;
+  }
+#endif
+}
+// ----------------------------------------------------------------
+void ST7567_SWSPI::begin()
+{
+  pinMode(csPin, OUTPUT);
+  pinMode(dcPin, OUTPUT);
+  pinMode(sdiPin, OUTPUT);
+  pinMode(clkPin, OUTPUT);
+  PIN_INIT(cs);
+  PIN_INIT(dc);
+  PIN_INIT(sdi);
+  PIN_INIT(clk);
+  PIN_LOW(clk);
+}
+// ----------------------------------------------------------------
+void ST7567_SWSPI::csActive()  { PIN_LOW(cs); }
+void ST7567_SWSPI::csIdle()    { PIN_HIGH(cs); }
+void ST7567_SWSPI::dcCommand() { PIN_LOW(dc); }
+void ST7567_SWSPI::dcData()    { PIN_HIGH(dc); }
+// ----------------------------------------------------------------
+void ST7567_SWSPI::write(uint8_t v)
+{
+#ifdef USE_FAST_PINIO
+  for(uint8_t bit=0x80; bit; bit>>=1) {
+    if(v & bit) PIN_HIGH(sdi); else PIN_LOW(sdi);
+    PIN_HIGH(clk);
+    PIN_LOW(clk);
+  }
+#else
+  shiftOut(sdiPin, clkPin, MSBFIRST, v);
+#endif
+}
+// ----------------------------------------------------------------
+void ST7567_Record::write(uint8_t v)
+{
+  if(cmd) cmdCnt++;
+  else { dataCnt++; sum1 = (sum1+v)%255; sum2 = (sum2+sum1)%255; }
+  if(log && logLen<logSize) log[logLen++] = cmd ? v|REC_CMD : v;
+  if(next) next->write(v);
+}
+// ----------------------------------------------------------------
+void ST7567_Record::write(const uint8_t *buf, uint16_t n)
+{
+  if(cmd) cmdCnt+=n;
+  else {
+    dataCnt+=n;
+    for(uint16_t i=0; i<n; i++) { sum1 = (sum1+buf[i])%255; sum2 = (sum2+sum1)%255; }
+  }
+  for(uint16_t i=0; i<n && log && logLen<logSize; i++) log[logLen++] = cmd ? buf[i]|REC_CMD : buf[i];
+  if(next) next->write(buf,n);
+}
+// ----------------------------------------------------------------
@@ -0,0 +1,106 @@
+// Transport layer for ST7567_FB library
+// (C) 2020 by Pawel A. Hernik
+
+/*
+ ST7567_Transport is the only place where bytes and CS/DC lines are touched.
+ Backends:
+  ST7567_HWSPI  - hardware SPI, bulk transfers of whole buffers
+  ST7567_SWSPI  - software SPI, direct port access on AVR (much faster than shiftOut)
+  ST7567_Record - counts, checksums and optionally logs the byte stream, can forward it to another backend
+*/
+
+#ifndef _ST7567_TRANSPORT_H
+#define _ST7567_TRANSPORT_H
+
+#include <Arduino.h>
+
+#ifdef __AVR__
+#define USE_FAST_PINIO
+typedef volatile uint8_t portReg_t;
+typedef uint8_t portMask_t;
+#endif
+
+// ---------------------------------
+class ST7567_Transport {
+public:
+  virtual ~ST7567_Transport() {}
+  virtual void begin() {}
+  virtual void csActive() = 0;
+  virtual void csIdle() = 0;
+  virtual void dcCommand() = 0;
+  virtual void dcData() = 0;
+  virtual void write(uint8_t v) = 0;
+  virtual void write(const uint8_t *buf, uint16_t n) { while(n--) write(*buf++); }
+  // asynchronous (DMA/interrupt) backends may return from write(buf,n) before the end of transfer,
+  // they have to report it here, buffer stays untouched by the caller until then,
+  // other calls wait for completion, except csIdle() which releases CS at the end of transfer
+  virtual bool busy() { return false; }
+
+  void writeCommands(const uint8_t *buf, uint16_t n) { dcCommand(); write(buf,n); }
+  void writeData(const uint8_t *buf, uint16_t n) { dcData(); write(buf,n); }
+};
+
+// ---------------------------------
+class ST7567_HWSPI : public ST7567_Transport {
+public:
+  ST7567_HWSPI(uint8_t dc, uint8_t cs) { dcPin = dc; csPin = cs; }
+  void begin();
+  void csActive();
+  void csIdle();
+  void dcCommand();
+  void dcData();
+  void write(uint8_t v);
+  void write(const uint8_t *buf, uint16_t n);
+
+  uint8_t dcPin, csPin;
+#ifdef USE_FAST_PINIO
+  portReg_t *dcPort, *csPort;
+  portMask_t dcMask, csMask;
+#endif
+};
+
+// ---------------------------------
+class ST7567_SWSPI : public ST7567_Transport {
+public:
+  ST7567_SWSPI(uint8_t dc, uint8_t cs, uint8_t sdi, uint8_t clk) { dcPin = dc; csPin = cs; sdiPin = sdi; clkPin = clk; }
+  void begin();
+  void csActive();
+  void csIdle();
+  void dcCommand();
+  void dcData();
+  void write(uint8_t v);
+
+  uint8_t dcPin, csPin, sdiPin, clkPin;
+#ifdef USE_FAST_PINIO
+  portReg_t *dcPort, *csPort, *sdiPort, *clkPort;
+  portMask_t dcMask, csMask, sdiMask, clkMask;
+#endif
+};
+
+// ---------------------------------
+// log entries: byte value, bit 8 set for commands
+#define REC_CMD 0x100
+
+class ST7567_Record : public ST7567_Transport {
+public:
+  ST7567_Record(ST7567_Transport *_next=NULL) { next = _next; log = NULL; logSize = 0; cmd = false; reset(); }
+  void begin() { if(next) next->begin(); }
+  void csActive() { csCnt++; if(next) next->csActive(); }
+  void csIdle() { if(next) next->csIdle(); }
+  void dcCommand() { cmd = true; dcCnt++; if(next) next->dcCommand(); }
+  void dcData() { cmd = false; dcCnt++; if(next) next->dcData(); }
+  void write(uint8_t v);
+  void write(const uint8_t *buf, uint16_t n);
+  void setLog(uint16_t *buf, uint16_t size) { log = buf; logSize = size; logLen = 0; }
+  void reset() { dataCnt = cmdCnt = csCnt = dcCnt = 0; logLen = 0; sum1 = sum2 = 0; }
+  uint16_t dataSum() { return (sum2<<8)|sum1; }  // Fletcher-16 of data bytes, compares frames without storing them
+
+  ST7567_Transport *next;
+  bool cmd;
+  uint32_t dataCnt, cmdCnt, csCnt, dcCnt;  // csCnt - CS activations, dcCnt - DC line writes
+  uint8_t sum1, sum2;
+  uint16_t *log;
+  uint16_t logSize, logLen;
+};
+
+#endif
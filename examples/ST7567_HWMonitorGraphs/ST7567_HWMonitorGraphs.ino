@@ -29,6 +29,7 @@
 #define LCD_RST        9
 
 #include "ST7567_FB.h"
+#include "ST7567_Chart.h"
 #include <SPI.h>
 ST7567_FB lcd(LCD_DC, LCD_RST, LCD_CS);
 
@@ -118,84 +119,66 @@ int readSerial()
 #define MAX_CLOCK 2900
 #define MIN_TEMP 30
 #define MAX_TEMP 80
-#define NUM_VAL (16)
-int tempTab[NUM_VAL];
-int loadTab[NUM_VAL];
-int clockTab[NUM_VAL];
-int ramTab[NUM_VAL];
-int i,ght=31-7;
-int x=0;
-
-void addLoad()
+#define NUM_VAL 15  // 4 columns per sample
+int ght=31-7;
+
+// history is kept by charts, new sample shifts only the chart area
+uint8_t tempTab[NUM_VAL+1];
+uint8_t loadTab[NUM_VAL+1];
+uint8_t clockTab[NUM_VAL+1];
+uint8_t ramTab[NUM_VAL+1];
+ST7567_Chart tempChart(lcd, 0+1,7+1,60,ght-2,tempTab,NUM_VAL);
+ST7567_Chart loadChart(lcd, 66+1,7+1,60,ght-2,loadTab,NUM_VAL);
+ST7567_Chart clockChart(lcd,0+1,33+1,60,ght-2,clockTab,NUM_VAL);
+ST7567_Chart ramChart(lcd,  66+1,33+1,60,ght-2,ramTab,NUM_VAL);
+bool started = false;
+
+void initGraph(ST7567_Chart &chart, int lo, int hi)
 {
-  for(i=0;i<NUM_VAL-1;i++) loadTab[i]=loadTab[i+1];
-  loadTab[NUM_VAL-1] = cpuLoad*(ght-1)/100;
-}
-
-void addClock()
-{
-  for(i=0;i<NUM_VAL-1;i++) clockTab[i]=clockTab[i+1];
-  int t = cpuClock;
-  if(t<MIN_CLOCK) t=MIN_CLOCK;
-  if(t>MAX_CLOCK) t=MAX_CLOCK;
-  clockTab[NUM_VAL-1] = (long)(t-MIN_CLOCK)*ght/(MAX_CLOCK-MIN_CLOCK);
-}
-
-void addTemp()
-{
-  for(i=0;i<NUM_VAL-1;i++) tempTab[i]=tempTab[i+1];
-  int t = cpuTemp;
-  if(t<MIN_TEMP) t=MIN_TEMP;
-  if(t>MAX_TEMP) t=MAX_TEMP;
-  tempTab[NUM_VAL-1] = (long)(t-MIN_TEMP)*ght/(MAX_TEMP-MIN_TEMP);
-}
-
-void addRAM()
-{
-  for(i=0;i<NUM_VAL-1;i++) ramTab[i]=ramTab[i+1];
-  ramTab[NUM_VAL-1] = (long)usedRam*ght/MAX_RAM;
-}
-
-void drawGraph(int xg, int yg, int valTab[])
-{
-  lcd.drawRectD(xg,yg,62,ght,1);
+  lcd.drawRectD(chart.x-1,chart.y-1,chart.w+2,chart.h+2,1);
+  chart.setRange(lo,hi);
 #ifdef GRAPH_BAR
-  for(i=1;i<NUM_VAL;i++) {
-    lcd.fillRectD(1+xg+(i-1)*4,yg+ght-1-valTab[i],4,valTab[i],1);
-    lcd.drawLineH(1+xg+(i-1)*4,1+xg+(i+0)*4-1,yg+ght-1-valTab[i],1);
-    if(i>1) lcd.drawLineV(1+xg+(i-1)*4,yg+ght-1-valTab[i-1],yg+ght-1-valTab[i],1);
-  }
+  chart.setStyle(CHART_BAR);
 #else
-  for(i=0;i<NUM_VAL-1;i++) {
-    int dy = valTab[i+1]-valTab[i];
-    for(int j=0;j<4;j++) lcd.drawLineVfastD(1+xg+i*4+j,yg+ght-1-(valTab[i]+dy*j/4),yg+ght-1,1);
-    lcd.drawLine(1+xg+i*4,yg+ght-1-valTab[i],1+xg+(i+1)*4,yg+ght-1-valTab[i+1],1);
-  }
+  chart.setStyle(CHART_FILLED);
 #endif
+  chart.clear();
+}
+
+void printLabel(int x, int y, int w)
+{
+  lcd.fillRect(x,y,w,6,0);
+  lcd.printStr(x,y,buf);
 }
 
 void loop() 
 {
-  readSerial();
-  //if(readSerial()) 
-  {
-    int xs=68;
+  if(!readSerial()) return;
+  if(!started) {
     lcd.cls();
-    lcd.setFont(Small4x6PL);
-    snprintf(buf,30,"Temp: %d'C",cpuTemp); lcd.printStr(9, 0, buf);
-    snprintf(buf,30,"Load: %d%%",cpuLoad); lcd.printStr(13+64, 0, buf);
-    snprintf(buf,30,"Clock: %dMHz",cpuClock); lcd.printStr(0, 32+32-6, buf);
-    snprintf(buf,30,"RAM: %dMB",usedRam); lcd.printStr(7+64, 32+32-6, buf);
-
-    if(inp==3) addClock();
-    if(inp==2) addRAM();
-    if(inp==1) { addLoad(); addTemp(); }
-    drawGraph(0,7,tempTab);
-    drawGraph(66,7,loadTab);
-    drawGraph(0,33,clockTab);
-    drawGraph(66,33,ramTab);
+    initGraph(tempChart,MIN_TEMP,MAX_TEMP);
+    initGraph(loadChart,0,100);
+    initGraph(clockChart,MIN_CLOCK,MAX_CLOCK);
+    initGraph(ramChart,0,MAX_RAM);
     lcd.display();
+    lcd.setFont(Small4x6PL);
+    started = true;
+  }
+  if(inp==1) {
+    snprintf(buf,30,"Temp: %d'C",cpuTemp); printLabel(9, 0, 55);
+    snprintf(buf,30,"Load: %d%%",cpuLoad); printLabel(13+64, 0, 51);
+    tempChart.add(cpuTemp);
+    loadChart.add(cpuLoad);
+  }
+  if(inp==2) {
+    snprintf(buf,30,"RAM: %dMB",usedRam); printLabel(7+64, 32+32-6, 57);
+    ramChart.add(usedRam);
   }
+  if(inp==3) {
+    snprintf(buf,30,"Clock: %dMHz",cpuClock); printLabel(0, 32+32-6, 64);
+    clockChart.add(cpuClock);
+  }
+  lcd.displayDirty();  // labels and shifted chart areas only
   if(inp>=3) { delay(1000); inp=0; }
 }
-
+
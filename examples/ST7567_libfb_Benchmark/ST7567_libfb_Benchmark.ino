@@ -0,0 +1,729 @@
+// ST7567 LCD FB library example
+// Benchmark of all primitives and check of optimized functions against drawPixel() reference
+// Results are sent to serial port
+// Needs more than 2KB of RAM (Mega 2560, ARM, ESP), on PC it runs by: make -C extras/host bench
+// (c) 2020 Pawel A. Hernik
+
+/*
+ 128x64 ST7567 connections in SPI mode (only 5-6 wires between LCD and MCU):
+
+ #01 LED  -> D6, GND or any pin via resistor
+ #02 RST  -> D9 or any pin
+ #03 CS   -> D10 or any pin
+ #04 DC   -> D8 or any pin
+ #05 SCK  -> D13/SCK
+ #06 SDI  -> D11/MOSI
+ #07 3V3  -> VCC (3.3V)
+ #08 GND  -> GND
+*/
+
+#define LCD_BL  6
+#define LCD_CS  10
+#define LCD_DC  8
+#define LCD_RST 9
+
+#include "ST7567_FB.h"
+#include "ST7567_Dither.h"
+#include "ST7567_Emu.h"
+#include <SPI.h>
+
+#if defined(__AVR__) && RAMEND<=0x8ff
+#error "Benchmark needs more than 2KB of RAM"
+#endif
+
+// recorder counts bytes sent to real LCD, controller model keeps what the glass shows
+ST7567_HWSPI spi(LCD_DC, LCD_CS);
+ST7567_Emu emu(&spi);
+ST7567_Record rec(&emu);
+ST7567_FB lcd(&rec, LCD_RST);
+
+#include "font5x7.h"
+
+const uint8_t sprite[] PROGMEM = { 12,13,
+  0xf8,0x04,0xf2,0x09,0x05,0x05,0x05,0x05,0x09,0xf2,0x04,0xf8,
+  0x03,0x04,0x09,0x12,0x14,0x14,0x14,0x14,0x12,0x09,0x04,0x03
+};
+
+const uint8_t spriteMask[] PROGMEM = { 12,13,
+  0xf8,0xfc,0xfe,0xff,0xff,0xff,0xff,0xff,0xff,0xfe,0xfc,0xf8,
+  0x03,0x07,0x0f,0x1f,0x1f,0x1f,0x1f,0x1f,0x1f,0x0f,0x07,0x03
+};
+
+// compressed by extras/pbm2rle.py
+const uint8_t spriteRLE[] PROGMEM = { 12,13,
+  0x03,0xf8,0x04,0xf2,0x09,0xc3,0x05,0x07,0x09,0xf2,0x04,0xf8,0x03,0x04,0x09,0x12,
+  0xc3,0x14,0x03,0x12,0x09,0x04,0x03,
+};
+
+// larger image with empty areas, the same in raw and compressed form
+const uint8_t ring[] PROGMEM = { 32,24,
+  0x00,0x00,0x00,0x00,0x00,0x80,0xc0,0xf0,0xf8,0x78,0x3c,0x1e,0x1e,0x0e,0x0e,0x0e,
+  0x0e,0x0e,0x0e,0x1e,0x1e,0x3c,0x78,0xf8,0xf0,0xc0,0x80,0x00,0x00,0x00,0x00,0x00,
+  0x00,0x00,0x00,0x00,0x00,0xff,0xff,0xff,0x81,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+  0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x81,0xff,0xff,0xff,0x00,0x00,0x00,0x00,0x00,
+  0x80,0x80,0x80,0x80,0x80,0x81,0x83,0x8f,0x9f,0x9e,0xbc,0xf8,0xf8,0xf0,0xf0,0xf0,
+  0xf0,0xf0,0xf0,0xf8,0xf8,0xbc,0x9e,0x9f,0x8f,0x83,0x81,0x80,0x80,0x80,0x80,0x80,
+};
+
+const uint8_t ringRLE[] PROGMEM = { 32,24,
+  0x84,0x07,0x80,0xc0,0xf0,0xf8,0x78,0x3c,0x1e,0x1e,0xc5,0x0e,0x07,0x1e,0x1e,0x3c,
+  0x78,0xf8,0xf0,0xc0,0x80,0x89,0xc2,0xff,0x00,0x81,0x8d,0x00,0x81,0xc2,0xff,0x84,
+  0xc4,0x80,0x07,0x81,0x83,0x8f,0x9f,0x9e,0xbc,0xf8,0xf8,0xc5,0xf0,0x07,0xf8,0xf8,
+  0xbc,0x9e,0x9f,0x8f,0x83,0x81,0xc4,0x80,
+};
+
+// small font, regular and packed by extras/fontpack.py
+const uint8_t digits[] PROGMEM = { (uint8_t)-5, 11, '0', ':',
+  5,0xfc,0x03,0x83,0x04,0x63,0x04,0x13,0x04,0xfc,0x03,  // '0'
+  3,0x0c,0x04,0xff,0x07,0x00,0x04,0x00,0x00,0x00,0x00,  // '1'
+  5,0x0c,0x04,0x03,0x07,0x83,0x04,0x63,0x04,0x1c,0x04,  // '2'
+  5,0x03,0x03,0x03,0x04,0x13,0x04,0x6f,0x04,0x83,0x03,  // '3'
+  5,0xe0,0x00,0x90,0x00,0x8c,0x00,0xff,0x07,0x80,0x00,  // '4'
+  5,0x1f,0x03,0x13,0x04,0x13,0x04,0x13,0x04,0xe3,0x03,  // '5'
+  5,0xf0,0x03,0x6c,0x04,0x63,0x04,0x63,0x04,0x80,0x03,  // '6'
+  5,0x03,0x00,0x83,0x07,0x63,0x00,0x13,0x00,0x0f,0x00,  // '7'
+  5,0x9c,0x03,0x63,0x04,0x63,0x04,0x63,0x04,0x9c,0x03,  // '8'
+  5,0x1c,0x00,0x63,0x04,0x63,0x04,0x63,0x03,0xfc,0x00,  // '9'
+  1,0x0c,0x03,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // ':'
+};
+
+const uint8_t digitsPacked[] PROGMEM = {
+  0, (uint8_t)-5, 11, '0', ':',
+  0x1d,0x00, 0x25,0x00, 0x2b,0x00, 0x33,0x00, 0x3b,0x00, 0x43,0x00, 0x4b,0x00, 0x53,0x00,
+  0x5b,0x00, 0x63,0x00, 0x6b,0x00, 0x6e,0x00,
+  5,0xfc,0x1b,0xe4,0x18,0x27,0xc8,0x3f,  // '0'
+  3,0x0c,0xfc,0x3f,0x00,0x01,  // '1'
+  5,0x0c,0x1c,0xf8,0x20,0xc7,0xc8,0x41,  // '2'
+  5,0x03,0x1b,0xe0,0x04,0xdf,0x38,0x38,  // '3'
+  5,0xe0,0x80,0x04,0x23,0xfe,0x0f,0x08,  // '4'
+  5,0x1f,0x9b,0xe0,0x04,0x27,0x38,0x3e,  // '5'
+  5,0xf0,0x63,0xe3,0x18,0xc7,0x08,0x38,  // '6'
+  5,0x03,0x18,0xfc,0x18,0x26,0xf0,0x00,  // '7'
+  5,0x9c,0x1b,0xe3,0x18,0xc7,0xc8,0x39,  // '8'
+  5,0x1c,0x18,0xe3,0x18,0xc7,0xc6,0x0f,  // '9'
+  1,0x0c,0x03,  // ':'
+};
+
+// ----------------------------------------------------------------
+// random parameters, the same set is used for each function
+#define NPAR 32
+struct Par { uint8_t x0,y0,x1,y1,w,h; } par[NPAR];
+
+void initPar()
+{
+  randomSeed(1234);
+  for(int i=0;i<NPAR;i++) {
+    Par &p = par[i];
+    p.x0 = random(SCR_WD);  p.x1 = random(SCR_WD);
+    p.y0 = random(SCR_HT);  p.y1 = random(SCR_HT);
+    p.w  = random(1,SCR_WD-p.x0+1);
+    p.h  = random(1,SCR_HT-p.y0+1);
+  }
+}
+
+// ----------------------------------------------------------------
+// reference versions built on drawPixel() only
+bool dith;
+void refPixel(int x, int y, uint8_t col)
+{
+  if(x<0 || y<0 || x>=lcd.scrWd || y>=lcd.scrHtPx) return;
+  if(!dith || (lcd.pattern[x&3] & (1<<(y&7)))) lcd.drawPixel(x,y,col);
+}
+
+void refH(int x0, int x1, int y, uint8_t col)
+{
+  if(x1<x0) { int t=x0; x0=x1; x1=t; }
+  for(int x=x0;x<=x1;x++) refPixel(x,y,col);
+}
+
+void refV(int x, int y0, int y1, uint8_t col)
+{
+  if(y1<y0) { int t=y0; y0=y1; y1=t; }
+  for(int y=y0;y<=y1;y++) refPixel(x,y,col);
+}
+
+// per pixel Bresenham, previous drawLine()
+void refLine(int x0, int y0, int x1, int y1, uint8_t col)
+{
+  int dx = abs(x1-x0), dy = abs(y1-y0);
+  int sx = x0<x1 ? 1 : -1, sy = y0<y1 ? 1 : -1;
+  int err = dx-dy;
+  while(1) {
+    refPixel(x0,y0,col);
+    if(x0==x1 && y0==y1) return;
+    int err2 = err+err;
+    if(err2>-dy) { err-=dy; x0+=sx; }
+    if(err2< dx) { err+=dx; y0+=sy; }
+  }
+}
+
+// previous drawLine(), drawPixel() for each pixel, for speed comparison
+void prevLine(Par &p, uint8_t col)
+{
+  int x0 = p.x0, y0 = p.y0, x1 = p.x1, y1 = p.y1;
+  int dx = abs(x1-x0), dy = abs(y1-y0);
+  int sx = x0<x1 ? 1 : -1, sy = y0<y1 ? 1 : -1;
+  int err = dx-dy;
+  while(1) {
+    lcd.drawPixel(x0,y0,col);
+    if(x0==x1 && y0==y1) return;
+    int err2 = err+err;
+    if(err2>-dy) { err-=dy; x0+=sx; }
+    if(err2< dx) { err+=dx; y0+=sy; }
+  }
+}
+
+void refRect(Par &p, uint8_t col)
+{
+  refH(p.x0,p.x0+p.w-1,p.y0,col);
+  if(p.h>1) refH(p.x0,p.x0+p.w-1,p.y0+p.h-1,col);
+  if(p.h>2) {
+    refV(p.x0,p.y0+1,p.y0+p.h-2,col);
+    if(p.w>1) refV(p.x0+p.w-1,p.y0+1,p.y0+p.h-2,col);
+  }
+}
+
+void refFill(Par &p, uint8_t col)
+{
+  for(int x=p.x0;x<p.x0+p.w;x++) refV(x,p.y0,p.y0+p.h-1,col);
+}
+
+// previous fillRect(), column by column, for speed comparison
+void prevFill(Par &p, uint8_t col)
+{
+  int w = p.w, h = p.h;
+  if(p.x0+w>lcd.scrWd) w = lcd.scrWd-p.x0;
+  if(p.y0+h>lcd.scrHtPx) h = lcd.scrHtPx-p.y0;
+  for(int x=p.x0;x<p.x0+w;x++) lcd.drawLineVfast(x,p.y0,p.y0+h-1,col);
+}
+
+// midpoint circle, 8 octant pixels or columns from top to 1 pixel below bottom like fillCircle()
+void refCircle(int x0, int y0, int r, uint8_t col, bool fill)
+{
+  int f = 1-r, ddx = 1, ddy = -2*r, x = 0, y = r;
+  if(fill) refV(x0,y0-r,y0+r+1,col);
+  else { refPixel(x0,y0+r,col); refPixel(x0,y0-r,col); refPixel(x0+r,y0,col); refPixel(x0-r,y0,col); }
+  while(x<y) {
+    if(f>=0) { y--; ddy+=2; f+=ddy; }
+    x++; ddx+=2; f+=ddx;
+    if(fill) {
+      refV(x0+x,y0-y,y0+y+1,col); refV(x0+y,y0-x,y0+x+1,col);
+      refV(x0-x,y0-y,y0+y+1,col); refV(x0-y,y0-x,y0+x+1,col);
+    } else {
+      refPixel(x0+x,y0+y,col); refPixel(x0-x,y0+y,col); refPixel(x0+x,y0-y,col); refPixel(x0-x,y0-y,col);
+      refPixel(x0+y,y0+x,col); refPixel(x0-y,y0+x,col); refPixel(x0+y,y0-x,col); refPixel(x0-y,y0-x,col);
+    }
+  }
+}
+
+// triangle columns from vertices sorted by x, edge y interpolated with truncating division
+void refTriangle(int x0, int y0, int x1, int y1, int x2, int y2, uint8_t col)
+{
+  int t;
+  if(x0>x1) { t=x0; x0=x1; x1=t; t=y0; y0=y1; y1=t; }
+  if(x1>x2) { t=x1; x1=x2; x2=t; t=y1; y1=y2; y2=t; }
+  if(x0>x1) { t=x0; x0=x1; x1=t; t=y0; y0=y1; y1=t; }
+  if(x0==x2) { refV(x0,min(y0,min(y1,y2)),max(y0,max(y1,y2)),col); return; }
+  for(int x=x0;x<=x2;x++) {
+    int b = y0+(long)(y2-y0)*(x-x0)/(x2-x0);
+    int a = x<x1 || (x==x1 && x1==x2) ? y0+(x1>x0 ? (long)(y1-y0)*(x-x0)/(x1-x0) : 0) : y1+(long)(y2-y1)*(x-x1)/(x2-x1);
+    refV(x,a,b,col);
+  }
+}
+
+bool bmpPixel(const uint8_t *bmp, int x, int y)
+{
+  return pgm_read_byte(bmp+2+(y/8)*pgm_read_byte(bmp)+x) & (1<<(y&7));
+}
+
+void refBlit(const uint8_t *bmp, int x0, int y0, uint8_t rop, const uint8_t *mask)
+{
+  uint8_t w=pgm_read_byte(bmp), h=pgm_read_byte(bmp+1);
+  for(int y=0;y<h;y++) for(int x=0;x<w;x++) {
+    if(x0+x<0 || y0+y<0 || (mask && !bmpPixel(mask,x,y))) continue;
+    bool b = bmpPixel(bmp,x,y);
+    if(rop==COPY) lcd.drawPixel(x0+x,y0+y,b);
+    else if(b) lcd.drawPixel(x0+x,y0+y,rop);
+  }
+}
+
+void refBitmap(Par &p, uint8_t col)
+{
+  refBlit(sprite,p.x0,p.y0,SET,NULL);
+}
+
+void refBitmapRLE(Par &p, uint8_t col)
+{
+  refBlit(ring,p.x0,p.y0,SET,NULL);
+}
+
+// concave arrow from random parameters (may intersect itself), clip version is 3x larger and shifted
+#define POLY_N 7
+int16_t poly[POLY_N*2];
+const int16_t *polyPts(Par &p, bool clip)
+{
+  int16_t v[POLY_N*2] = { p.x0,p.y0, p.x1,p.y1, (int16_t)(p.x0+p.w),p.y1, (int16_t)(p.x0+p.w/2),(int16_t)(p.y0+p.h/3),
+                          (int16_t)(p.x0+p.w),(int16_t)(p.y0+p.h), (int16_t)(p.x1/2),(int16_t)(p.y0+p.h), p.x0,(int16_t)(p.y0+p.h/2) };
+  for(int i=0;i<POLY_N*2;i++) poly[i] = clip ? v[i]*3-(i&1 ? 64 : 128) : v[i];
+  return poly;
+}
+
+// pixel center (x+0.5,y+0.5) is inside when odd number of edges crosses column center above or at it
+void refPoly(const int16_t *pts, uint8_t n, uint8_t col)
+{
+  for(int y=0;y<lcd.scrHtPx;y++) for(int x=0;x<lcd.scrWd;x++) {
+    bool in = false;
+    for(int i=0;i<n;i++) {
+      const int16_t *a = pts+i*2, *b = pts+(i+1)%n*2;
+      if(a[0]>b[0]) { const int16_t *t = a; a = b; b = t; }
+      if(x<a[0] || x>=b[0]) continue;
+      long dx = b[0]-a[0], dy = b[1]-a[1];
+      if(2L*a[1]*dx+dy*(2L*(x-a[0])+1)<=(2L*y+1)*dx) in = !in;
+    }
+    if(in) refPixel(x,y,col);
+  }
+}
+
+// font without minimal widths, spacing=1
+void refStr(int x, int y, const char *s)
+{
+  _propFont &f = lcd.cfont;
+  int fwd = abs(f.xSize), fht8 = (f.ySize+7)/8;
+  for(; *s; s++) {
+    uint8_t c = *s;
+    if(c<f.firstCh || c>f.lastCh) { x += c==' ' ? 1+fwd/2 : 0; continue; }
+    const uint8_t *g = f.font+4+(c-f.firstCh)*(fwd*fht8+1);
+    int wd = pgm_read_byte(g++);
+    for(int i=0;i<wd;i++) for(int yy=0;yy<f.ySize;yy++)
+      if(pgm_read_byte(g+i*fht8+yy/8) & (1<<(yy&7))) lcd.drawPixel(x+i,y+yy,1);
+    x += wd+1;
+  }
+}
+
+// ----------------------------------------------------------------
+typedef void (*OpFun)(Par &p, uint8_t col);
+struct Test {
+  const char *name;
+  OpFun fast, ref;
+  int8_t dither;  // pattern set before test, 0 - no dithering
+};
+
+Test tests[] = {
+  { "drawPixel",      [](Par &p, uint8_t c) { lcd.drawPixel(p.x0,p.y0,c); }, NULL, 0 },
+  { "drawLine",       [](Par &p, uint8_t c) { lcd.drawLine(p.x0,p.y0,p.x1,p.y1,c); }, [](Par &p, uint8_t c) { refLine(p.x0,p.y0,p.x1,p.y1,c); }, 0 },
+  { "drawLineD",      [](Par &p, uint8_t c) { lcd.drawLineD(p.x0,p.y0,p.x1,p.y1,c); }, [](Par &p, uint8_t c) { refLine(p.x0,p.y0,p.x1,p.y1,c); }, 8 },
+  { "drawLine per pixel", prevLine, [](Par &p, uint8_t c) { refLine(p.x0,p.y0,p.x1,p.y1,c); }, 0 },
+  { "drawLine clip",  [](Par &p, uint8_t c) { lcd.drawLine(p.x0*5-256,p.y0*5-128,p.x1*3-128,p.y1*3-64,c); },
+                      [](Par &p, uint8_t c) { refLine(p.x0*5-256,p.y0*5-128,p.x1*3-128,p.y1*3-64,c); }, 0 },
+  { "drawLineH",      [](Par &p, uint8_t c) { lcd.drawLineH(p.x0,p.x1,p.y0,c); }, [](Par &p, uint8_t c) { refH(p.x0,p.x1,p.y0,c); }, 0 },
+  { "drawLineV",      [](Par &p, uint8_t c) { lcd.drawLineV(p.x0,p.y0,p.y1,c); }, [](Par &p, uint8_t c) { refV(p.x0,p.y0,p.y1,c); }, 0 },
+  { "drawLineHfast",  [](Par &p, uint8_t c) { lcd.drawLineHfast(p.x0,p.x1,p.y0,c); }, [](Par &p, uint8_t c) { refH(p.x0,p.x1,p.y0,c); }, 0 },
+  { "drawLineHfastD", [](Par &p, uint8_t c) { lcd.drawLineHfastD(p.x0,p.x1,p.y0,c); }, [](Par &p, uint8_t c) { refH(p.x0,p.x1,p.y0,c); }, 8 },
+  { "drawLineVfast",  [](Par &p, uint8_t c) { lcd.drawLineVfast(p.x0,p.y0,p.y1,c); }, [](Par &p, uint8_t c) { refV(p.x0,p.y0,p.y1,c); }, 0 },
+  { "drawLineVfastD", [](Par &p, uint8_t c) { lcd.drawLineVfastD(p.x0,p.y0,p.y1,c); }, [](Par &p, uint8_t c) { refV(p.x0,p.y0,p.y1,c); }, 5 },
+  { "drawRect",       [](Par &p, uint8_t c) { lcd.drawRect(p.x0,p.y0,p.w,p.h,c); }, refRect, 0 },
+  { "drawRectD",      [](Par &p, uint8_t c) { lcd.drawRectD(p.x0,p.y0,p.w,p.h,c); }, refRect, 8 },
+  { "fillRect",       [](Par &p, uint8_t c) { lcd.fillRect(p.x0,p.y0,p.w,p.h,c); }, refFill, 0 },
+  { "fillRectD",      [](Par &p, uint8_t c) { lcd.fillRectD(p.x0,p.y0,p.w,p.h,c); }, refFill, 11 },
+  { "fillRect by columns", prevFill, refFill, 0 },
+  { "drawCircle",     [](Par &p, uint8_t c) { lcd.drawCircle(p.x0,p.y0,p.h/2,c); }, [](Par &p, uint8_t c) { refCircle(p.x0,p.y0,p.h/2,c,false); }, 0 },
+  { "fillCircle",     [](Par &p, uint8_t c) { lcd.fillCircle(p.x0,p.y0,p.h/2,c); }, [](Par &p, uint8_t c) { refCircle(p.x0,p.y0,p.h/2,c,true); }, 0 },
+  { "fillCircleD",    [](Par &p, uint8_t c) { lcd.fillCircleD(p.x0,p.y0,p.h/2,c); }, [](Par &p, uint8_t c) { refCircle(p.x0,p.y0,p.h/2,c,true); }, 8 },
+  { "drawTriangle",   [](Par &p, uint8_t c) { lcd.drawTriangle(p.x0,p.y0,p.x1,p.y1,p.x0+p.w-1,p.y1,c); },
+                      [](Par &p, uint8_t c) { refLine(p.x0,p.y0,p.x1,p.y1,c); refLine(p.x1,p.y1,p.x0+p.w-1,p.y1,c); refLine(p.x0+p.w-1,p.y1,p.x0,p.y0,c); }, 0 },
+  { "fillTriangle",   [](Par &p, uint8_t c) { lcd.fillTriangle(p.x0,p.y0,p.x1,p.y1,p.x0+p.w-1,p.y1,c); }, [](Par &p, uint8_t c) { refTriangle(p.x0,p.y0,p.x1,p.y1,p.x0+p.w-1,p.y1,c); }, 0 },
+  { "fillTriangleD",  [](Par &p, uint8_t c) { lcd.fillTriangleD(p.x0,p.y0,p.x1,p.y1,p.x0+p.w-1,p.y1,c); }, [](Par &p, uint8_t c) { refTriangle(p.x0,p.y0,p.x1,p.y1,p.x0+p.w-1,p.y1,c); }, 8 },
+  { "fillPolygon",    [](Par &p, uint8_t c) { lcd.fillPolygon(polyPts(p,false),POLY_N,c); }, [](Par &p, uint8_t c) { refPoly(polyPts(p,false),POLY_N,c); }, 0 },
+  { "fillPolygonD",   [](Par &p, uint8_t c) { lcd.fillPolygonD(polyPts(p,false),POLY_N,c); }, [](Par &p, uint8_t c) { refPoly(polyPts(p,false),POLY_N,c); }, 8 },
+  { "fillPolygon triangle",[](Par &p, uint8_t c) { int16_t t[6] = { p.x0,p.y0,p.x1,p.y1,(int16_t)(p.x0+p.w-1),p.y1 }; lcd.fillPolygon(t,3,c); },
+                      [](Par &p, uint8_t c) { int16_t t[6] = { p.x0,p.y0,p.x1,p.y1,(int16_t)(p.x0+p.w-1),p.y1 }; refPoly(t,3,c); }, 0 },
+  { "fillPolygon clip",[](Par &p, uint8_t c) { lcd.fillPolygon(polyPts(p,true),POLY_N,c); }, [](Par &p, uint8_t c) { refPoly(polyPts(p,true),POLY_N,c); }, 0 },
+  { "drawBitmap",     [](Par &p, uint8_t c) { lcd.drawBitmap(sprite,p.x0,p.y0); }, refBitmap, 0 },
+  { "blitBitmap",     [](Par &p, uint8_t c) { lcd.blitBitmap(sprite,p.x0-6,p.y0-6,c); }, [](Par &p, uint8_t c) { refBlit(sprite,p.x0-6,p.y0-6,c,NULL); }, 0 },
+  { "blitBitmap+mask",[](Par &p, uint8_t c) { lcd.blitBitmap(sprite,p.x0-6,p.y0-6,c,spriteMask); }, [](Par &p, uint8_t c) { refBlit(sprite,p.x0-6,p.y0-6,c,spriteMask); }, 0 },
+  { "blitBitmap COPY",[](Par &p, uint8_t c) { lcd.blitBitmap(sprite,p.x0-6,p.y0-6,COPY,c ? spriteMask : NULL); }, [](Par &p, uint8_t c) { refBlit(sprite,p.x0-6,p.y0-6,COPY,c ? spriteMask : NULL); }, 0 },
+  { "blitBitmap ring",[](Par &p, uint8_t c) { lcd.blitBitmap(ring,p.x0-16,p.y0-12,c); }, [](Par &p, uint8_t c) { refBlit(ring,p.x0-16,p.y0-12,c,NULL); }, 0 },
+  { "drawBitmapRLE",  [](Par &p, uint8_t c) { lcd.drawBitmapRLE(ringRLE,p.x0,p.y0); }, refBitmapRLE, 0 },
+  { "blitBitmapRLE",  [](Par &p, uint8_t c) { lcd.blitBitmapRLE(ringRLE,p.x0-16,p.y0-12,c); }, [](Par &p, uint8_t c) { refBlit(ring,p.x0-16,p.y0-12,c,NULL); }, 0 },
+  { "blitBitmapRLE sprite",[](Par &p, uint8_t c) { lcd.blitBitmapRLE(spriteRLE,p.x0-6,p.y0-6,c); }, [](Par &p, uint8_t c) { refBlit(sprite,p.x0-6,p.y0-6,c,NULL); }, 0 },
+  { "blitBitmapRLE COPY",[](Par &p, uint8_t c) { lcd.blitBitmapRLE(ringRLE,p.x0-16,p.y0-12,COPY); }, [](Par &p, uint8_t c) { refBlit(ring,p.x0-16,p.y0-12,COPY,NULL); }, 0 },
+  { "printStr",       [](Par &p, uint8_t c) { lcd.printStr(p.x0,p.y0,(char*)"Test 123"); }, [](Par &p, uint8_t c) { refStr(p.x0,p.y0,"Test 123"); }, 0 },
+  { "printStr opaque",[](Par &p, uint8_t c) { lcd.setOpaque(1); lcd.printStr(p.x0,p.y0,(char*)"Test 123"); lcd.setOpaque(0); },
+                      [](Par &p, uint8_t c) { lcd.fillRect(p.x0,p.y0,lcd.strWidth((char*)"Test 123"),lcd.fontHeight(),0); refStr(p.x0,p.y0,"Test 123"); }, 0 },
+  { "printStr digits",[](Par &p, uint8_t c) { lcd.setFont(digits); lcd.printStr(p.x0,p.y0,(char*)"12:34"); lcd.setFont(font5x7); },
+                      [](Par &p, uint8_t c) { lcd.setFont(digits); refStr(p.x0,p.y0,"12:34"); lcd.setFont(font5x7); }, 0 },
+  { "printStr packed",[](Par &p, uint8_t c) { lcd.setFont(digitsPacked); lcd.printStr(p.x0,p.y0,(char*)"12:34"); lcd.setFont(font5x7); },
+                      [](Par &p, uint8_t c) { lcd.setFont(digits); refStr(p.x0,p.y0,"12:34"); lcd.setFont(font5x7); }, 0 },
+  { "printStr packed opaque",[](Par &p, uint8_t c) { lcd.setFont(digitsPacked); lcd.setOpaque(1); lcd.printStr(p.x0-8,p.y0-4,(char*)"12:34"); lcd.setFont(font5x7); },
+                      [](Par &p, uint8_t c) { lcd.setFont(digits); lcd.setOpaque(1); lcd.printStr(p.x0-8,p.y0-4,(char*)"12:34"); lcd.setFont(font5x7); }, 0 },
+};
+
+// ----------------------------------------------------------------
+// pseudo random screen, any byte can be calculated again, so references don't need a copy of frame
+byte screenByte(uint16_t i)
+{
+  uint16_t h = (i+777)*40503u;
+  h ^= h>>7;
+  h *= 0x2c1b;
+  return h>>8;
+}
+
+void randomScreen()
+{
+  for(int i=0;i<lcd.scrWd*lcd.scrHt;i++) lcd.scr[i] = screenByte(i);
+}
+
+uint16_t checksum()
+{
+  uint16_t s1=0, s2=0;
+  for(int i=0;i<lcd.scrWd*lcd.scrHt;i++) { s1=(s1+lcd.scr[i])%255; s2=(s2+s1)%255; }
+  return (s2<<8)|s1;
+}
+
+// what the glass shows, doesn't depend on order of bytes sent
+uint16_t glassSum()
+{
+  uint16_t s1=0, s2=0;
+  for(int y=0;y<EMU_GLASS_HT;y++) for(int x=0;x<EMU_GLASS_WD;x+=8) {
+    byte b = 0;
+    for(int i=0;i<8;i++) if(emu.glassPixel(x+i,y)) b |= 1<<i;
+    s1=(s1+b)%255; s2=(s2+s1)%255;
+  }
+  return (s2<<8)|s1;
+}
+
+uint16_t dirtyBytes()
+{
+  uint16_t n=0;
+#ifdef USE_DIRTY_TRACKING
+  for(int i=0;i<lcd.scrHt;i++) if(lcd.dirtyMin[i]<=lcd.dirtyMax[i]) n+=lcd.dirtyMax[i]-lcd.dirtyMin[i]+1;
+#endif
+  return n;
+}
+
+#ifndef BENCH_REP
+#define BENCH_REP 10  // repetitions of timed loops, host build uses more for stable results
+#endif
+const char *colName[3] = { "CLR", "SET", "XOR" };
+int errors = 0;
+
+void runTest(Test &t)
+{
+  lcd.setDither(t.dither);
+  dith = t.dither!=0;
+  Serial.print(t.name);
+  // speed
+  int rep = BENCH_REP;
+  unsigned long tm = micros();
+  for(int r=0;r<rep;r++) for(int i=0;i<NPAR;i++) t.fast(par[i],r%3);
+  tm = micros()-tm;
+  Serial.print(F("  ns/op: "));
+  Serial.print(tm*1000UL/(rep*NPAR));
+  // framebuffer bytes touched
+  uint32_t touched = 0;
+  for(int i=0;i<NPAR;i++) { lcd.clearDirty(); t.fast(par[i],SET); touched += dirtyBytes(); }
+  Serial.print(F("  bytes/op: "));
+  Serial.print(touched/NPAR);
+  // comparison with reference
+  if(t.ref) {
+    for(int c=0;c<3;c++) {
+      randomScreen();
+      for(int i=0;i<NPAR;i++) t.fast(par[i],c);
+      uint16_t cs = checksum();
+      randomScreen();
+      for(int i=0;i<NPAR;i++) t.ref(par[i],c);
+      bool ok = cs==checksum();
+      if(!ok) errors++;
+      Serial.print("  ");
+      Serial.print(colName[c]);
+      Serial.print(ok ? F(":ok") : F(":FAIL"));
+    }
+  }
+  Serial.println();
+}
+
+// ----------------------------------------------------------------
+void flushStats(const char *name)
+{
+  Serial.print(name);
+  Serial.print(F("  data: "));
+  Serial.print(rec.dataCnt);
+  Serial.print(F("  cmd: "));
+  Serial.print(rec.cmdCnt);
+  Serial.print(F("  cs: "));
+  Serial.print(rec.csCnt);
+  Serial.print(F("  dc: "));
+  Serial.println(rec.dcCnt);
+  rec.reset();
+}
+
+void runFlush()
+{
+  lcd.cls();
+  rec.reset(); lcd.display();                                        flushStats("display");
+  lcd.printStr(0,0,(char*)"12:34"); rec.reset(); lcd.displayDirty(); flushStats("displayDirty (text)");
+  lcd.drawPixel(5,60,1); rec.reset(); lcd.displayDirty();            flushStats("displayDirty (pixel)");
+#ifdef USE_SHADOW_BUF
+  lcd.scr[100]^=0xff; rec.reset(); lcd.displayDiff();                flushStats("displayDiff (1 byte)");
+#endif
+
+  rec.reset(); lcd.copy(10,2,50,3);                                  flushStats("copy 50x3");
+  rec.reset(); lcd.beginFlush(); while(!lcd.flushStep(32));          flushStats("flushStep(32)");
+}
+
+// ----------------------------------------------------------------
+// full frame in landscape and portrait, portrait pays for transposing 128 tiles of 8x8
+// transpose8() twice must give the same tile back
+void runRotation()
+{
+  bool ok = true;
+  for(uint8_t r=0; r<2; r++) {
+    lcd.setRotation(r);
+    randomScreen();
+    int rep = BENCH_REP*4;
+    unsigned long t = micros();
+    for(int i=0;i<rep;i++) lcd.display();
+    t = micros()-t;
+    rec.reset();
+    lcd.display();
+    ok &= rec.dataCnt==lcd.scrWd*lcd.scrHt;
+    Serial.print(r ? F("portrait  ns/frame: ") : F("landscape  ns/frame: "));
+    Serial.print(t*1000UL/rep);
+    Serial.print(F("  "));
+    flushStats(r ? "display 64x128" : "display 128x64");
+  }
+  byte a[8], b[8];
+  for(uint16_t i=0; i<lcd.scrWd*lcd.scrHt; i+=8) {
+    ST7567_FB::transpose8(lcd.scr+i,a);
+    ST7567_FB::transpose8(a,b);
+    ok &= !memcmp(b,lcd.scr+i,8);
+  }
+  lcd.setRotation(0);
+  if(!ok) errors++;
+  Serial.println(ok ? F("rotation ok") : F("rotation FAIL"));
+}
+
+// ----------------------------------------------------------------
+// scrollRegion() on random screen checked against pixel by pixel copy, fill 0, 1 and wrap (-1)
+void refScroll(Par &p, int dx, int dy, int fill)
+{
+  int w = p.w, h = p.h;
+  for(int y=0;y<h;y++) for(int x=0;x<w;x++) {
+    int sx = x-dx, sy = y-dy;
+    if(fill<0) { sx = (sx%w+w)%w; sy = (sy%h+h)%h; }
+    bool b = fill>0;
+    if(sx>=0 && sx<w && sy>=0 && sy<h) b = screenByte((p.y0+sy)/8*lcd.scrWd+p.x0+sx) & (1<<((p.y0+sy)&7));
+    lcd.drawPixel(p.x0+x,p.y0+y,b);
+  }
+}
+
+// ticker: whole text line redrawn 1 pixel left vs scrolled
+void runScroll()
+{
+  for(int fill=-1;fill<=1;fill++) {
+    bool ok = true;
+    for(int i=0;i<NPAR;i++) {
+      randomScreen();
+      lcd.scrollRegion(par[i].x0,par[i].y0,par[i].w,par[i].h,(par[i].x1-64)/4,(par[i].y1-32)/4,fill);
+      uint16_t cs = checksum();
+      randomScreen();
+      refScroll(par[i],(par[i].x1-64)/4,(par[i].y1-32)/4,fill);
+      ok &= cs==checksum();
+    }
+    if(!ok) errors++;
+    Serial.print(F("scrollRegion fill "));
+    Serial.print(fill);
+    Serial.println(ok ? F("  ok") : F("  FAIL"));
+  }
+  int rep = BENCH_REP*16;
+  lcd.cls();
+  unsigned long tm = micros();
+  for(int r=0;r<rep;r++) { lcd.fillRect(0,20,SCR_WD,16,0); lcd.printStr(-(r&63),20,(char*)"Ticker text line 0123456789"); }
+  tm = micros()-tm;
+  Serial.print(F("ticker redraw  ns/step: "));
+  Serial.println(tm*1000UL/rep);
+  tm = micros();
+  for(int r=0;r<rep;r++) lcd.scrollRegion(0,20,SCR_WD,16,-1,0);
+  tm = micros()-tm;
+  Serial.print(F("ticker scrollRegion  ns/step: "));
+  Serial.println(tm*1000UL/rep);
+  tm = micros();
+  for(int r=0;r<rep;r++) lcd.scrollRegion(0,3,SCR_WD,50,0,-1,-1);
+  tm = micros()-tm;
+  Serial.print(F("vertical wrap 128x50  ns/step: "));
+  Serial.println(tm*1000UL/rep);
+}
+
+// ----------------------------------------------------------------
+// greyscale conversion speed and density of uniform grey (set pixels should match the level)
+int16_t ditherErr[3*(SCR_WD+4)];
+ST7567_Dither dither(lcd,ditherErr);
+const char *kernelName[4] = { "threshold", "ordered", "Floyd-Steinberg", "Atkinson" };
+
+void runDither()
+{
+  uint8_t row[SCR_WD];
+  for(int k=DITHER_THRESHOLD;k<=DITHER_ATKINSON;k++) {
+    dither.setKernel(k);
+    int rep = 4;
+    unsigned long tm = micros();
+    for(int r=0;r<rep;r++) {
+      dither.begin(0,0,SCR_WD);
+      for(int y=0;y<SCR_HT;y++) {
+        for(int x=0;x<SCR_WD;x++) row[x] = x*2+y;
+        dither.putRow(row);
+      }
+    }
+    tm = micros()-tm;
+    Serial.print(kernelName[k]);
+    Serial.print(F("  kpix/s: "));
+    Serial.print(tm ? (uint32_t)rep*SCR_WD*SCR_HT*1000UL/tm : 0);
+    if(k==DITHER_THRESHOLD) { Serial.println(); continue; }
+    bool ok = true;
+    long prev = -1;
+    for(int v=32;v<255;v+=64) {
+      lcd.cls();
+      dither.drawGradient(0,0,SCR_WD,SCR_HT,v,v);
+      long cnt = 0;
+      for(int i=0;i<SCR_WD*SCR_HT8;i++) for(uint8_t b=lcd.scr[i]; b; b&=b-1) cnt++;
+      long exp = (long)v*SCR_WD*SCR_HT/255;
+      // Atkinson loses 1/4 of error, light and dark tones are pushed to the ends
+      if(abs(cnt-exp)>(k==DITHER_ATKINSON ? SCR_WD*SCR_HT/6 : SCR_WD*SCR_HT/64) || cnt<prev) ok = false;
+      prev = cnt;
+    }
+    if(!ok) errors++;
+    Serial.println(ok ? F("  density: ok") : F("  density: FAIL"));
+  }
+}
+
+#ifdef USE_PAGE_MODE
+// ----------------------------------------------------------------
+// the same calls drawn into frame buffer and in page mode must give the same picture on the glass,
+// in portrait tiles are sent in different order, so bytes are not compared, time includes drawing and display()
+#define NPAGE 8  // calls per test, all must fit in the list
+byte band[SCR_WD];
+byte list[400];
+
+void pageModeTests()
+{
+  for(unsigned int t=0;t<sizeof(tests)/sizeof(tests[0]);t++) {
+    Test &ts = tests[t];
+    if(ts.fast==prevLine || ts.fast==prevFill) continue;  // speed comparison only, too many calls for the display list
+    lcd.setDither(ts.dither);
+    unsigned long tm = micros();
+    lcd.cls();
+    for(int i=0;i<NPAGE;i++) ts.fast(par[i],i%3);
+    rec.reset(); lcd.display();
+    unsigned long tmFull = micros()-tm;
+    uint16_t sum = glassSum();
+
+    lcd.beginPageMode(band,list,sizeof(list));
+    tm = micros();
+    lcd.cls();
+    for(int i=0;i<NPAGE;i++) ts.fast(par[i],i%3);
+    rec.reset(); lcd.display();
+    tm = micros()-tm;
+    bool ok = sum==glassSum() && !lcd.dlOverflow;
+    if(!ok) errors++;
+    Serial.print(ts.name);
+    Serial.print(F("  us: "));
+    Serial.print(tmFull);
+    Serial.print(F(" / "));
+    Serial.print(tm);
+    Serial.print(F("  list: "));
+    Serial.print(lcd.dlLen);
+    Serial.println(ok ? F("  ok") : F("  FAIL"));
+    lcd.endPageMode();
+  }
+  rec.reset();
+}
+
+void runPageMode()
+{
+  Serial.println(F("page mode  us full/page, list bytes"));
+  pageModeTests();
+  lcd.setRotation(1);
+  Serial.println(F("page mode portrait"));
+  pageModeTests();
+  lcd.setRotation(0);
+}
+#endif
+
+// ----------------------------------------------------------------
+#ifdef USE_STATS
+// built-in counters after typical dashboard update, bus counters checked against recorder
+const char *statName[STAT_PRIMS] = { "pixel", "line", "rect", "fill", "circle", "triangle", "polygon", "bitmap", "text", "scroll" };
+
+void runStats()
+{
+  lcd.cls();
+  lcd.display();
+  lcd.resetStats();
+  rec.reset();
+  for(int i=0;i<10;i++) {
+    lcd.fillRect(0,0,64,16,0);
+    lcd.printStr(0,0,(char*)"12:34");
+    lcd.drawRect(70,2,50,12,1);
+    lcd.fillRect(72,4,i*4,8,1);
+    lcd.drawLine(0,63,127,20+i,2);
+    lcd.blitBitmap(sprite,100,40,XOR);
+    lcd.displayDirty();
+  }
+  ST7567_Stats &s = lcd.stats;
+  for(int i=0;i<STAT_PRIMS;i++) {
+    if(!s.calls[i]) continue;
+    Serial.print(statName[i]);
+    Serial.print(F("  calls: "));
+    Serial.print(s.calls[i]);
+    Serial.print(F("  bytes/call: "));
+    Serial.println(s.bytes[i]/s.calls[i]);
+  }
+  Serial.print(F("flushes: "));
+  Serial.print(s.flushes);
+  Serial.print(F("  us last/avg/max: "));
+  Serial.print(s.flushUs);
+  Serial.print('/');
+  Serial.print(s.flushUsAvg());
+  Serial.print('/');
+  Serial.print(s.flushUsMax);
+  bool ok = s.dataBytes==rec.dataCnt && s.cmdBytes==rec.cmdCnt && s.csCnt==rec.csCnt && s.flushes==10;
+  if(!ok) errors++;
+  Serial.println(ok ? F("  bus counters ok") : F("  bus counters FAIL"));
+}
+#endif
+
+void setup() 
+{
+  Serial.begin(115200);
+  pinMode(LCD_BL, OUTPUT);
+  digitalWrite(LCD_BL, LOW);
+  lcd.init();
+  lcd.setFont(font5x7);
+  initPar();
+  Serial.println(F("ST7567_FB benchmark"));
+  for(unsigned int i=0;i<sizeof(tests)/sizeof(tests[0]);i++) runTest(tests[i]);
+  // the same on 64x128 canvas, parameters partially outside check clipping
+  lcd.setRotation(1);
+  Serial.println(F("portrait 64x128"));
+  for(unsigned int i=0;i<sizeof(tests)/sizeof(tests[0]);i++) runTest(tests[i]);
+  lcd.setRotation(0);
+  runFlush();
+  runRotation();
+  runScroll();
+  runDither();
+#ifdef USE_STATS
+  runStats();
+#endif
+#ifdef USE_PAGE_MODE
+  runPageMode();
+#endif
+  Serial.print(F("Errors: "));
+  Serial.println(errors);
+  lcd.cls();
+  lcd.printStr(ALIGN_CENTER,28,errors ? (char*)"Errors found" : (char*)"All OK");
+  lcd.display();
+}
+
+void loop() 
+{
+}
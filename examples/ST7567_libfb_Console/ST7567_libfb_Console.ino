@@ -0,0 +1,53 @@
+// ST7567 LCD FB library example
+// Log console scrolled by LCD start line register, each new line sends only its own pages
+// (c) 2020 Pawel A. Hernik
+
+/*
+ 128x64 ST7567 connections in SPI mode (only 5-6 wires between LCD and MCU):
+
+ #01 LED  -> D6, GND or any pin via resistor
+ #02 RST  -> D9 or any pin
+ #03 CS   -> D10 or any pin
+ #04 DC   -> D8 or any pin
+ #05 SCK  -> D13/SCK
+ #06 SDI  -> D11/MOSI
+ #07 3V3  -> VCC (3.3V)
+ #08 GND  -> GND
+*/
+
+#define LCD_BL  6
+#define LCD_CS  10
+#define LCD_DC  8
+#define LCD_RST 9
+
+#include "ST7567_FB.h"
+#include "ST7567_Console.h"
+#include <SPI.h>
+ST7567_FB lcd(LCD_DC, LCD_RST, LCD_CS);
+ST7567_Console con(lcd);
+
+// from PropFonts library
+#include "small4x6_font.h"
+
+void setup() 
+{
+  Serial.begin(9600);
+  pinMode(LCD_BL, OUTPUT);
+  digitalWrite(LCD_BL, LOW);
+  lcd.init();
+  //lcd.setRotation(2);
+  con.begin(Small4x6PL);  // 8 pixel lines, 8 lines on the screen
+  con.println("ST7567 log console");
+}
+
+unsigned long cnt = 0;
+
+void loop() 
+{
+  con.print(millis()/1000.0,1);
+  con.print(" s  A0=");
+  con.print(analogRead(A0));
+  if(++cnt%5==0) con.print("  a long line is wrapped at the right edge");
+  con.println();
+  delay(500);
+}
@@ -0,0 +1,70 @@
+// ST7567 LCD FB library example
+// Dumps what LCD shows as PBM images to serial port, useful for reference images
+// (c) 2020 Pawel A. Hernik
+
+/*
+ 128x64 ST7567 connections in SPI mode (only 5-6 wires between LCD and MCU):
+
+ #01 LED  -> D6, GND or any pin via resistor
+ #02 RST  -> D9 or any pin
+ #03 CS   -> D10 or any pin
+ #04 DC   -> D8 or any pin
+ #05 SCK  -> D13/SCK
+ #06 SDI  -> D11/MOSI
+ #07 3V3  -> VCC (3.3V)
+ #08 GND  -> GND
+*/
+
+#define LCD_BL  6
+#define LCD_CS  10
+#define LCD_DC  8
+#define LCD_RST 9
+
+#include "ST7567_FB.h"
+#include "ST7567_Emu.h"
+#include <SPI.h>
+
+// controller model placed between library and real LCD
+ST7567_HWSPI spi(LCD_DC, LCD_CS);
+ST7567_Emu emu(&spi);
+ST7567_FB lcd(&emu, LCD_RST);
+
+void dump(const char *name)
+{
+  Serial.print("# ");
+  Serial.println(name);
+  emu.dumpPBM(Serial);
+}
+
+void setup() 
+{
+  Serial.begin(115200);
+  pinMode(LCD_BL, OUTPUT);
+  digitalWrite(LCD_BL, LOW);
+  lcd.init();
+  lcd.setRotation(0);
+  lcd.cls();
+  lcd.drawRect(0,0,SCR_WD,SCR_HT,1);
+  lcd.fillTriangle(10,50,30,10,50,50,1);
+  lcd.fillCircleD(80,32,20,1);
+  lcd.display();
+  dump("rotation 0");
+
+  lcd.setRotation(2);
+  lcd.display();
+  dump("rotation 2");
+
+  lcd.setRotation(0);
+  lcd.display();
+  lcd.setScroll(16);
+  dump("scroll 16");
+
+  lcd.setScroll(0);
+  lcd.fillRect(40,16,48,16,2);
+  lcd.copy(40,2,48,2);
+  dump("copy");
+}
+
+void loop() 
+{
+}
@@ -0,0 +1,71 @@
+// ST7567_FB example
+// 8 grey levels by 3 bitplanes shown with weighted durations
+// Needs 3KB of RAM for frame buffers (Mega, STM32 etc.)
+// (C)2020 Pawel A. Hernik
+
+/*
+ 128x64 ST7567 connections in SPI mode (only 5-6 wires between LCD and MCU):
+
+ #01 LED  -> D6, GND or any pin via resistor
+ #02 RST  -> D9 or any pin
+ #03 CS   -> D10 or any pin
+ #04 DC   -> D8 or any pin
+ #05 SCK  -> D13/SCK
+ #06 SDI  -> D11/MOSI
+ #07 3V3  -> VCC (3.3V)
+ #08 GND  -> GND
+*/
+
+#define LCD_BL         6
+#define LCD_CS         10
+#define LCD_DC         8
+#define LCD_RST        9
+
+#include "ST7567_FB.h"
+#include "ST7567_Grey.h"
+#include <SPI.h>
+ST7567_FB lcd(LCD_DC, LCD_RST, LCD_CS);
+
+// plane 0 is lcd frame buffer
+byte plane1[SCR_WD*SCR_HT8];
+byte plane2[SCR_WD*SCR_HT8];
+ST7567_Grey grey(lcd, plane1, plane2);
+
+// from PropFonts library
+#include "c64enh_font.h"
+
+void setup() 
+{
+  Serial.begin(115200);
+  pinMode(LCD_BL, OUTPUT);
+  digitalWrite(LCD_BL, LOW);
+  lcd.init();
+  lcd.setFont(c64enh);
+  grey.cls(0);
+  for(int i=0;i<8;i++) grey.fillRect(i*16,0,16,40,i);
+  grey.printStr(ALIGN_CENTER,44,(char*)"Greyscale",7,2);
+  grey.fillCircle(12,56,7,3);
+  grey.fillCircle(115,56,7,5);
+  // plane 0 time, full cycle takes 7 slots
+  grey.setSlot(2500);
+  grey.start();
+}
+
+unsigned long ms = 0;
+
+void loop() 
+{
+  grey.update();
+  // stats every 2s, printing takes time so a plane can be dropped here
+  if(millis()-ms>2000) {
+    ms = millis();
+    Serial.print(grey.rate);
+    Serial.print(F(" Hz, dropped: "));
+    Serial.print(grey.dropped);
+    Serial.print(F(", late max: "));
+    Serial.print(grey.lateMax);
+    Serial.print(F("us, plane: "));
+    Serial.print(grey.flushUs);
+    Serial.println(F("us"));
+  }
+}
@@ -0,0 +1,124 @@
+// ST7567_FB example
+// 8-bit greyscale converted by ordered dithering and error diffusion
+// Image can be also streamed from serial port: 'I', width, height and width*height bytes
+// (C)2020 Pawel A. Hernik
+
+/*
+ 128x64 ST7567 connections in SPI mode (only 5-6 wires between LCD and MCU):
+
+ #01 LED  -> D6, GND or any pin via resistor
+ #02 RST  -> D9 or any pin
+ #03 CS   -> D10 or any pin
+ #04 DC   -> D8 or any pin
+ #05 SCK  -> D13/SCK
+ #06 SDI  -> D11/MOSI
+ #07 3V3  -> VCC (3.3V)
+ #08 GND  -> GND
+*/
+
+#define LCD_BL         6
+#define LCD_CS         10
+#define LCD_DC         8
+#define LCD_RST        9
+
+#include "ST7567_FB.h"
+#include "ST7567_Dither.h"
+#include <SPI.h>
+ST7567_FB lcd(LCD_DC, LCD_RST, LCD_CS);
+
+// 2 rows of errors are enough for Floyd-Steinberg, 3 for Atkinson
+int16_t err[3*(SCR_WD+4)];
+ST7567_Dither dither(lcd, err);
+
+// from PropFonts library
+#include "small4x6_font.h"
+
+// own ordered matrix: diagonal line screen
+const uint8_t lineScreen[64] PROGMEM = {
+   16, 48, 80,112,144,176,208,240,
+   48, 80,112,144,176,208,240, 16,
+   80,112,144,176,208,240, 16, 48,
+  112,144,176,208,240, 16, 48, 80,
+  144,176,208,240, 16, 48, 80,112,
+  176,208,240, 16, 48, 80,112,144,
+  208,240, 16, 48, 80,112,144,176,
+  240, 16, 48, 80,112,144,176,208
+};
+
+const char *names[4] = { "Threshold", "Bayer 8x8", "Floyd-St.", "Atkinson" };
+
+// shaded ball, rows are generated on the fly, only one row in RAM
+void ball(int x0, int y0, int r)
+{
+  uint8_t row[SCR_WD];
+  dither.begin(x0-r,y0-r,2*r);
+  for(int y=-r;y<r;y++) {
+    for(int x=-r;x<r;x++) {
+      long d = (long)x*x+(long)y*y;
+      if(d>=(long)r*r) { row[x+r] = 0; continue; }
+      int lx = x+r/3, ly = y+r/3;  // light from top-left
+      long l = 255-((long)lx*lx+(long)ly*ly)*255/(4L*r*r/3);
+      row[x+r] = l<0 ? 40 : 255-l*7/8;
+    }
+    dither.putRow(row);
+  }
+}
+
+void kernels()
+{
+  lcd.cls();
+  lcd.setFont(Small4x6PL);
+  for(int k=0;k<4;k++) {
+    dither.setKernel(k);
+    dither.drawGradient(k*32,0,32,56,0,255,true);
+    lcd.printStr(k*32+1,58,(char*)names[k]);
+  }
+  lcd.display();
+}
+
+void balls()
+{
+  lcd.cls();
+  for(int k=1;k<4;k++) {
+    dither.setKernel(k);
+    ball(k*32-8,32,20);
+  }
+  dither.setKernel(DITHER_ORDERED);
+  dither.setMatrix(lineScreen);
+  ball(112,32,15);
+  dither.setMatrix(NULL);
+  lcd.display();
+}
+
+// 'I', w, h, then rows, every row is converted when received
+void serialImage()
+{
+  while(Serial.available()<3) ;
+  uint8_t w = Serial.read(), h = Serial.read();
+  uint8_t row[SCR_WD];
+  if(w>SCR_WD) w = SCR_WD;
+  lcd.cls();
+  dither.setKernel(DITHER_FS);
+  dither.begin((SCR_WD-w)/2,(SCR_HT-h)/2,w);
+  for(int y=0;y<h;y++) {
+    for(int x=0;x<w;x++) { while(!Serial.available()) ; row[x] = Serial.read(); }
+    dither.putRow(row);
+  }
+  lcd.display();
+}
+
+void setup() 
+{
+  Serial.begin(115200);
+  pinMode(LCD_BL, OUTPUT);
+  digitalWrite(LCD_BL, LOW);
+  lcd.init();
+}
+
+void loop() 
+{
+  kernels();
+  for(int i=0;i<40;i++) { delay(100); if(Serial.available() && Serial.read()=='I') { serialImage(); delay(5000); } }
+  balls();
+  for(int i=0;i<40;i++) { delay(100); if(Serial.available() && Serial.read()=='I') { serialImage(); delay(5000); } }
+}
@@ -0,0 +1,92 @@
+// ST7567 LCD FB library example
+// Retained scene: only objects whose values change are redrawn and sent to LCD
+// Number of data bytes sent per update is printed to serial port
+// (c) 2020 Pawel A. Hernik
+
+/*
+ 128x64 ST7567 connections in SPI mode (only 5-6 wires between LCD and MCU):
+
+ #01 LED  -> D6, GND or any pin via resistor
+ #02 RST  -> D9 or any pin
+ #03 CS   -> D10 or any pin
+ #04 DC   -> D8 or any pin
+ #05 SCK  -> D13/SCK
+ #06 SDI  -> D11/MOSI
+ #07 3V3  -> VCC (3.3V)
+ #08 GND  -> GND
+*/
+
+#define LCD_BL  6
+#define LCD_CS  10
+#define LCD_DC  8
+#define LCD_RST 9
+
+#include "ST7567_FB.h"
+#include "ST7567_Scene.h"
+#include <SPI.h>
+
+ST7567_HWSPI spi(LCD_DC, LCD_CS);
+ST7567_Record rec(&spi);
+ST7567_FB lcd(&rec, LCD_RST);
+
+// from PropFonts library
+#include "c64enh_font.h"
+
+const uint8_t heart[] PROGMEM = { 9,8,
+  0x0c,0x1e,0x3e,0x7c,0xf8,0x7c,0x3e,0x1e,0x0c
+};
+
+ST7567_Text   clockTxt(0,0,64,c64enh,ALIGN_LEFT);
+ST7567_Text   tempTxt(64,0,64,c64enh,ALIGN_RIGHT);
+ST7567_Bar    cpuBar(0,14,100,9,100);
+ST7567_Bar    memBar(116,14,12,50,100,true);
+ST7567_Gauge  gauge(30,44,19,100);
+ST7567_Bitmap beat(70,40,heart);
+ST7567_Scene  scene(lcd);
+
+void setup() 
+{
+  Serial.begin(115200);
+  pinMode(LCD_BL, OUTPUT);
+  digitalWrite(LCD_BL, LOW);
+  lcd.init();
+  scene.add(&cpuBar);
+  scene.add(&memBar);
+  scene.add(&gauge);
+  scene.add(&beat);
+  scene.add(&clockTxt);
+  scene.add(&tempTxt);
+  clockTxt.setText("00:00:00");
+  tempTxt.setText("21.5'C");
+  scene.redrawAll();
+}
+
+char buf[20];
+unsigned long sec = 0, ms = 0;
+
+void loop() 
+{
+  if(millis()-ms>=1000) {
+    ms = millis();
+    sec++;
+    snprintf(buf,20,"%02d:%02d:%02d",int(sec/3600%24),int(sec/60%60),int(sec%60));
+    clockTxt.setText(buf);
+    if(sec%10==0) {
+      dtostrf(20+random(50)/10.0,4,1,buf);
+      strcat(buf,"'C");
+      tempTxt.setText(buf);
+    }
+    beat.setVisible(sec&1);
+  }
+  cpuBar.setValue(50+random(-10,11));
+  memBar.setValue(60+(millis()/2000)%10);
+  gauge.setValue(analogRead(A0)/10);
+  beat.moveTo(70+(millis()/200)%30,40);
+
+  rec.reset();
+  if(scene.update()) {
+    Serial.print(F("bytes sent: "));
+    Serial.println(rec.dataCnt);
+  }
+  delay(50);
+}
@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+# PropFonts font to packed font for ST7567_FB setFont()
+# (C) 2020 by Pawel A. Hernik
+#
+# usage: fontpack.py font.h [name] > font_packed.h
+# all font arrays found in the file are converted, name is used only when there is one array
+# glyphs get their own widths instead of fixed stride and columns are packed to ySize bits
+# flash saved is reported on stderr
+
+import re, sys
+
+def parseArrays(src):
+    src = re.sub(r'/\*.*?\*/', '', src, flags=re.S)
+    src = re.sub(r'//[^\n]*', '', src)
+    for m in re.finditer(r'(\w+)\s*\[\s*\]\s*(?:PROGMEM\s*)?=\s*\{(.*?)\}\s*;', src, re.S):  # ends at '};', '}' can be a char literal
+        body = re.sub(r'\(\s*(?:const\s+)?\w+\s*\)', '', m.group(2))  # casts
+        vals = []
+        for t in re.findall(r"'(?:\\.|[^\\'])'|[-+]?(?:0[xX][0-9a-fA-F]+|\d+)", body):
+            if t[0] == "'":
+                vals.append(ord(t[-2]))
+            else:
+                vals.append(int(t, 0))
+        yield m.group(1), [v & 0xff for v in vals]
+
+def pack(data):
+    xs = data[0] - 256 if data[0] > 127 else data[0]
+    ys, first, last = data[1], data[2], data[3]
+    if xs == 0:
+        sys.exit('font is already packed')
+    fwd, ht8 = abs(xs), (ys + 7) // 8
+    n = last - first + 1
+    if len(data) < 4 + n*(fwd*ht8+1):
+        sys.exit('font data is too short, %d glyphs expected' % n)
+    glyphs = []
+    for i in range(n):
+        g = data[4 + i*(fwd*ht8+1):4 + (i+1)*(fwd*ht8+1)]
+        wd = min(g[0], fwd)
+        bits = 0
+        for x in range(wd):
+            for y in range(ys):
+                if g[1 + x*ht8 + y//8] >> (y & 7) & 1:
+                    bits |= 1 << (x*ys + y)
+        nb = (wd*ys + 7) // 8
+        glyphs.append([wd] + [(bits >> (8*k)) & 0xff for k in range(nb)])
+    ofs = 5 + 2*(n+1)
+    index = []
+    for g in glyphs:
+        index.append(ofs)
+        ofs += len(g)
+    index.append(ofs)
+    if ofs > 0xffff:
+        sys.exit('packed font is bigger than 64KB')
+    return xs, ys, first, last, index, glyphs
+
+def charName(c):
+    return "'\\''" if c == 39 else "'\\\\'" if c == 92 else "'%c'" % c if 32 <= c < 127 else '%d' % c
+
+if len(sys.argv) < 2:
+    sys.exit('usage: fontpack.py font.h [name] > font_packed.h')
+arrays = list(parseArrays(open(sys.argv[1]).read()))
+if not arrays:
+    sys.exit('no font arrays found')
+for name, data in arrays:
+    if len(arrays) == 1 and len(sys.argv) > 2: name = sys.argv[2]
+    xs, ys, first, last, index, glyphs = pack(data)
+    size = index[-1]
+    print('// %s packed by fontpack.py, %d bytes, original %d bytes' % (name, size, len(data)))
+    print('const uint8_t %s[] PROGMEM = {' % name)
+    print('  0, %s, %d, %s, %s,' % ('(uint8_t)%d' % xs if xs < 0 else xs, ys, charName(first), charName(last)))
+    for i in range(0, len(index), 8):
+        print('  ' + ' '.join('0x%02x,0x%02x,' % (o & 0xff, o >> 8) for o in index[i:i+8]))
+    for i, g in enumerate(glyphs):
+        print('  %d,%s  // %s' % (g[0], ''.join('0x%02x,' % b for b in g[1:]), charName(first + i)))
+    print('};')
+    print()
+    sys.stderr.write('%s: %d -> %d bytes, saved %d (%d%%)\n' % (name, len(data), size, len(data) - size, (len(data) - size) * 100 // len(data)))
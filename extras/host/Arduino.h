@@ -0,0 +1,69 @@
+// Arduino API shim for host (Linux) build of ST7567_FB library
+// (C) 2020 by Pawel A. Hernik
+
+/*
+ Only what the library, tests and benchmark use. Pins and SPI do nothing,
+ micros() is real time, Serial prints to stdout, PROGMEM is plain memory.
+*/
+
+#ifndef _HOST_ARDUINO_H
+#define _HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <ctype.h>
+#include <algorithm>
+#include <avr/pgmspace.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW  0
+#define INPUT  0
+#define OUTPUT 1
+#define MSBFIRST 1
+#define LSBFIRST 0
+
+using std::min;
+using std::max;
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline void shiftOut(uint8_t, uint8_t, uint8_t, uint8_t) {}
+inline void delay(unsigned long) {}
+inline void delayMicroseconds(unsigned int) {}
+unsigned long micros();
+unsigned long millis();
+
+inline void randomSeed(unsigned long s) { srand(s); }
+inline long random(long hi) { return hi>0 ? rand()%hi : 0; }
+inline long random(long lo, long hi) { return hi>lo ? lo+rand()%(hi-lo) : lo; }
+
+#define F(s) (s)
+
+// ---------------------------------
+class Print {
+public:
+  virtual size_t write(uint8_t c) = 0;
+  size_t print(const char *s) { size_t n = 0; while(*s) n += write(*s++); return n; }
+  size_t print(char c) { return write(c); }
+  size_t print(long v) { char b[24]; snprintf(b,sizeof(b),"%ld",v); return print(b); }
+  size_t print(unsigned long v) { char b[24]; snprintf(b,sizeof(b),"%lu",v); return print(b); }
+  size_t print(int v) { return print((long)v); }
+  size_t print(unsigned int v) { return print((unsigned long)v); }
+  size_t print(double v, int d=2) { char b[32]; snprintf(b,sizeof(b),"%.*f",d,v); return print(b); }
+  size_t println() { return print("\r\n"); }
+  template<typename T> size_t println(T v) { size_t n = print(v); return n+println(); }
+};
+
+class HardwareSerial : public Print {
+public:
+  void begin(unsigned long) {}
+  size_t write(uint8_t c) { return fputc(c,stdout)==EOF ? 0 : 1; }
+};
+extern HardwareSerial Serial;
+
+#endif
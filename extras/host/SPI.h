@@ -0,0 +1,23 @@
+// SPI shim for host build of ST7567_FB library
+// (C) 2020 by Pawel A. Hernik
+
+#ifndef _HOST_SPI_H
+#define _HOST_SPI_H
+
+#include <Arduino.h>
+
+#define SPI_MODE0 0
+#define SPI_CLOCK_DIV2 0
+
+// bytes go nowhere, use ST7567_Record or ST7567_Emu transport to see them
+class SPIClass {
+public:
+  void begin() {}
+  void setDataMode(uint8_t) {}
+  void setClockDivider(uint8_t) {}
+  uint8_t transfer(uint8_t) { return 0; }
+  void transfer(void *buf, size_t n) { memset(buf,0,n); }
+};
+extern SPIClass SPI;
+
+#endif
@@ -0,0 +1,44 @@
+// Asynchronous test backend for ST7567_FB library, host build
+// (C) 2020 by Pawel A. Hernik
+
+/*
+ Behaves like a DMA/interrupt driven SPI backend: write(buf,n) only takes the buffer and returns,
+ bytes are read from it later, a few on each busy() poll, and passed to the next backend.
+ Other calls wait for the end of transfer, csIdle() during transfer releases CS when the last byte is sent.
+ Buffers reused or CS dropped before the end of transfer show up as wrong pixels on ST7567_Emu.
+*/
+
+#ifndef _ASYNC_BUS_H
+#define _ASYNC_BUS_H
+
+#include "ST7567_Transport.h"
+
+class AsyncBus : public ST7567_Transport {
+public:
+  AsyncBus(ST7567_Transport *_next, uint8_t _step=4) { next = _next; step = _step; buf = NULL; n = 0; csRelease = false; polls = busyPolls = 0; }
+  void begin() { next->begin(); }
+  void csActive() { finish(); next->csActive(); }
+  void csIdle() { if(n) csRelease = true; else next->csIdle(); }
+  void dcCommand() { finish(); next->dcCommand(); }
+  void dcData() { finish(); next->dcData(); }
+  void write(uint8_t v) { finish(); next->write(v); }
+  void write(const uint8_t *_buf, uint16_t _n) { finish(); buf = _buf; n = _n; }
+  bool busy() { polls++; if(n) { busyPolls++; pump(step); } return n>0; }
+
+  void finish() { while(n) pump(n); }
+  void pump(uint16_t k)
+  {
+    if(k>n) k = n;
+    while(k--) { next->write(*buf++); n--; }
+    if(!n && csRelease) { csRelease = false; next->csIdle(); }  // end of transfer "interrupt"
+  }
+
+  ST7567_Transport *next;
+  const uint8_t *buf;
+  uint16_t n;
+  uint8_t step;      // bytes sent on each busy() poll
+  bool csRelease;
+  uint32_t polls, busyPolls;  // busyPolls - polls which found transfer in progress
+};
+
+#endif
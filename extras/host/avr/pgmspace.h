@@ -0,0 +1,17 @@
+// PROGMEM shim for host build of ST7567_FB library
+// (C) 2020 by Pawel A. Hernik
+
+#ifndef _HOST_PGMSPACE_H
+#define _HOST_PGMSPACE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define pgm_read_word(p) (*(const uint16_t*)(p))
+#define pgm_read_ptr(p)  (*(void* const*)(p))
+#define memcpy_P memcpy
+#define strlen_P strlen
+
+#endif
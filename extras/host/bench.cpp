@@ -0,0 +1,10 @@
+// Benchmark example built on host, exit code is 1 when any check failed
+// (C) 2020 by Pawel A. Hernik
+
+#include "../../examples/ST7567_libfb_Benchmark/ST7567_libfb_Benchmark.ino"
+
+int main()
+{
+  setup();
+  return errors ? 1 : 0;
+}
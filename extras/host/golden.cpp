@@ -0,0 +1,266 @@
+// Golden image tests for ST7567_FB library, host build
+// (C) 2020 by Pawel A. Hernik
+
+/*
+ Frames are sent through ST7567_Emu and what the glass shows is compared with golden/<name>.pbm.
+ The same frames are also sent by flushStep() through AsyncBus, which completes transfers later like DMA.
+ Failed frames are written to out/<name>.pbm and out/<name>.png, out/<name>_diff.png marks changed pixels.
+ golden -u writes new golden images, use it only after checking that the change is intended.
+*/
+
+#include "ST7567_FB.h"
+#include "ST7567_Emu.h"
+#include "ST7567_Scene.h"
+#include "async_bus.h"
+#include "../../examples/ST7567_libfb_Benchmark/font5x7.h"
+#include "font5x7p.h"
+#include <string>
+#include <sys/stat.h>
+
+ST7567_Emu emu;
+ST7567_FB lcd(&emu);
+ST7567_Emu emuA;
+AsyncBus async(&emuA);
+ST7567_FB lcdA(&async);
+byte bufA[SCR_WD*SCR_HT8];
+bool update;
+int fails, tests;
+
+// ----------------------------------------------------------------
+class StrPrint : public Print {
+public:
+  std::string s;
+  size_t write(uint8_t c) { s += (char)c; return 1; }
+};
+
+static std::string readFile(const std::string &name)
+{
+  std::string s;
+  FILE *f = fopen(name.c_str(),"rb");
+  if(!f) return s;
+  char buf[512];
+  size_t n;
+  while((n = fread(buf,1,sizeof(buf),f))>0) s.append(buf,n);
+  fclose(f);
+  return s;
+}
+
+static void writeFile(const std::string &name, const std::string &s)
+{
+  FILE *f = fopen(name.c_str(),"wb");
+  if(!f) { printf("can't write %s\n",name.c_str()); return; }
+  fwrite(s.data(),1,s.size(),f);
+  fclose(f);
+}
+// ----------------------------------------------------------------
+// 1-bit PNG with stored (not compressed) deflate blocks, set pixel is black like on the glass
+static uint32_t crc32(const std::string &s, size_t from)
+{
+  uint32_t c = 0xffffffff;
+  for(size_t i=from; i<s.size(); i++) {
+    c ^= (uint8_t)s[i];
+    for(int k=0; k<8; k++) c = (c>>1) ^ (0xedb88320 & (0-(c&1)));
+  }
+  return ~c;
+}
+
+static void put32(std::string &s, uint32_t v)
+{
+  s += (char)(v>>24); s += (char)(v>>16); s += (char)(v>>8); s += (char)v;
+}
+
+static void chunk(std::string &png, const char *type, const std::string &data)
+{
+  put32(png,data.size());
+  size_t start = png.size();
+  png += type;
+  png += data;
+  put32(png,crc32(png,start));
+}
+
+static std::string pbmToPNG(const std::string &pbm, const std::string *ref)
+{
+  const char *p = pbm.c_str()+pbm.find('\n',3)+1;  // after "P1\n128 64\n"
+  const char *r = ref ? ref->c_str()+ref->find('\n',3)+1 : NULL;
+  std::string raw;
+  for(int y=0; y<EMU_GLASS_HT; y++, p++, r += r ? 1 : 0) {
+    raw += (char)0;  // filter: none
+    for(int x=0; x<EMU_GLASS_WD; x+=8) {
+      uint8_t b = 0xff;
+      for(int i=0; i<8; i++, p++) {
+        bool on = r ? *p!=r[0] : *p=='1';
+        if(r) r++;
+        if(on) b &= ~(0x80>>i);
+      }
+      raw += (char)b;
+    }
+  }
+  std::string z = "\x78\x01";
+  for(size_t i=0; i<raw.size(); i+=65535) {
+    uint16_t n = std::min<size_t>(raw.size()-i,65535);
+    z += (char)(i+n==raw.size());
+    z += (char)n; z += (char)(n>>8); z += (char)~n; z += (char)(~n>>8);
+    z += raw.substr(i,n);
+  }
+  uint32_t a = 1, b = 0;
+  for(size_t i=0; i<raw.size(); i++) { a = (a+(uint8_t)raw[i])%65521; b = (b+a)%65521; }
+  put32(z,(b<<16)|a);
+
+  std::string ihdr;
+  put32(ihdr,EMU_GLASS_WD);
+  put32(ihdr,EMU_GLASS_HT);
+  ihdr += std::string("\x01\x00\x00\x00\x00",5);  // 1 bit, greyscale
+  std::string png = "\x89PNG\r\n\x1a\n";
+  chunk(png,"IHDR",ihdr);
+  chunk(png,"IDAT",z);
+  chunk(png,"IEND","");
+  return png;
+}
+// ----------------------------------------------------------------
+static void check(const char *name, ST7567_Emu &e=emu, const char *tag="")
+{
+  StrPrint pbm;
+  e.dumpPBM(pbm);
+  std::string file = std::string("golden/")+name+".pbm";
+  tests++;
+  if(update) {
+    if(!*tag) writeFile(file,pbm.s);
+    printf("%s%-12s written\n",tag,name);
+    return;
+  }
+  std::string ref = readFile(file);
+  bool ok = ref==pbm.s;
+  printf("%s%-12s %s\n",tag,name,ok ? "ok" : ref.empty() ? "FAIL (no golden image)" : "FAIL");
+  if(ok) return;
+  fails++;
+  mkdir("out",0755);
+  std::string out = std::string("out/")+tag+name;
+  writeFile(out+".pbm",pbm.s);
+  writeFile(out+".png",pbmToPNG(pbm.s,NULL));
+  if(ref.size()==pbm.s.size()) writeFile(out+"_diff.png",pbmToPNG(pbm.s,&ref));
+}
+// ----------------------------------------------------------------
+// asymmetric scene, orientation is visible from the corner marks
+static void scene(ST7567_FB &lcd=::lcd)
+{
+  int w = lcd.scrWd, h = lcd.scrHtPx;
+  lcd.cls();
+  lcd.drawRect(0,0,w,h,1);
+  lcd.fillTriangle(2,2,17,2,2,17,1);     // top-left corner
+  lcd.fillRect(w-8,h-5,6,3,1);           // bottom-right bar
+  lcd.drawLine(2,h-3,w/2,h/3,1);
+  lcd.fillCircle(w/2+6,h/2+4,7,1);
+  lcd.setDither(8);
+  lcd.fillRectD(4,h/2,w/3,h/5,1);
+  for(int i=0; i<5; i++) lcd.drawPixel(w-4-i*2,3+i,1);
+}
+
+// scene update keeps sketch's clip rectangle, font and text settings, packed font text gets its height
+static void sceneTest()
+{
+  lcd.setRotation(0);
+  lcd.setScroll(0);
+  lcd.cls();
+  ST7567_Scene sc(lcd);
+  ST7567_Text txt(2,2,60,font5x7);
+  ST7567_Bar bar(2,12,60,8,100);
+  ST7567_Text ptxt(2,22,36,font5x7p,ALIGN_RIGHT);
+  sc.add(&txt);
+  sc.add(&bar);
+  sc.add(&ptxt);
+  txt.setText("Scene");
+  bar.setValue(40);
+  ptxt.setText("12");
+  sc.redrawAll();
+  lcd.drawLineHfast(0,lcd.scrWd-1,30,1);  // not a scene object
+  lcd.setFont(font5x7);
+  lcd.setInvert(1);
+  lcd.setClip(0,0,40,64);
+  txt.setText("Update");
+  bar.setValue(90);
+  ptxt.setText("345");
+  sc.update();
+  lcd.fillRect(30,40,40,8,1);     // ends at x=40
+  lcd.resetClip();
+  lcd.printStr(2,50,(char*)"abc");  // inverted
+  lcd.display();
+  check("scene");
+  if(ptxt.h!=8) { printf("packed font text height %d\n",ptxt.h); fails++; }
+}
+
+int main(int argc, char **argv)
+{
+  update = argc>1 && !strcmp(argv[1],"-u");
+  lcd.init();
+  for(int r=0; r<4; r++) {
+    char name[8];
+    lcd.setRotation(r);
+    scene();
+    lcd.display();
+    snprintf(name,sizeof(name),"rot%d",r);
+    check(name);
+  }
+
+  lcd.setRotation(0);
+  scene();
+  lcd.display();
+  lcd.setScroll(16);
+  check("scroll16");
+  lcd.setScroll(63);
+  check("scroll63");
+  lcd.setScroll(0);
+
+  // only copied area gets new content
+  lcd.fillRect(10,10,60,40,2);
+  lcd.copy(16,1,48,3);
+  check("copy");
+
+  lcd.setRotation(1);
+  scene();
+  lcd.display();
+  lcd.fillRect(4,20,50,90,2);
+  lcd.copy(12,4,40,7);
+  check("copy_rot1");
+
+  lcd.setRotation(2);
+  scene();
+  lcd.display();
+  lcd.setScroll(8);
+  check("scroll8_rot2");
+
+  sceneTest();
+
+  // asynchronous backend, frame is sent in small chunks while the loop could draw
+  lcdA.init();
+  lcdA.setBuffer(bufA);
+  for(int r=0; r<4; r++) {
+    char name[8];
+    lcdA.setRotation(r);
+    scene(lcdA);
+    lcdA.beginFlush();
+    while(!lcdA.flushStep(16));
+    async.finish();
+    snprintf(name,sizeof(name),"rot%d",r);
+    check(name,emuA,"async_");
+  }
+  lcdA.setRotation(1);
+  scene(lcdA);
+  lcdA.display();
+  async.finish();
+  check("rot1",emuA,"async_");
+#ifdef USE_PAGE_MODE
+  // band is drawn again only when the previous one was sent
+  static byte band[SCR_WD], list[400];
+  lcdA.setRotation(0);
+  lcdA.beginPageMode(band,list,sizeof(list));
+  scene(lcdA);
+  lcdA.display();
+  lcdA.endPageMode();
+  async.finish();
+  check("rot0",emuA,"async_page_");
+#endif
+  if(!async.busyPolls) { printf("async backend was never busy in flushStep()\n"); fails++; }
+
+  printf("%d tests, %d failed\n",tests,fails);
+  return fails ? 1 : 0;
+}
@@ -0,0 +1,21 @@
+// Arduino API shim for host (Linux) build of ST7567_FB library
+// (C) 2020 by Pawel A. Hernik
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <time.h>
+
+HardwareSerial Serial;
+SPIClass SPI;
+
+unsigned long micros()
+{
+  timespec t;
+  clock_gettime(CLOCK_MONOTONIC,&t);
+  return t.tv_sec*1000000UL+t.tv_nsec/1000;
+}
+
+unsigned long millis()
+{
+  return micros()/1000;
+}
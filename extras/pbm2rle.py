@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+# PBM image to compressed bitmap for ST7567_FB drawBitmapRLE()/blitBitmapRLE()
+# (C) 2020 by Pawel A. Hernik
+#
+# usage: pbm2rle.py image.pbm [name] > image.h
+# P1 (ASCII) and P4 (binary) PBM files are supported, black pixels are set
+# compression ratio is reported on stderr
+
+import sys
+
+def readPBM(fn):
+    data = open(fn, 'rb').read()
+    tok, pos = [], 0
+    # header: magic, width, height, comments allowed
+    while len(tok) < 3:
+        while data[pos:pos+1].isspace(): pos += 1
+        if data[pos:pos+1] == b'#':
+            while data[pos:pos+1] not in (b'\n', b''): pos += 1
+            continue
+        st = pos
+        while not data[pos:pos+1].isspace(): pos += 1
+        tok.append(data[st:pos])
+    magic, w, h = tok[0], int(tok[1]), int(tok[2])
+    pos += 1
+    if magic == b'P4':
+        stride = (w + 7) // 8
+        rows = [[(data[pos+y*stride+x//8] >> (7-x%8)) & 1 for x in range(w)] for y in range(h)]
+    elif magic == b'P1':
+        bits = [int(c) for c in data[pos:].decode() if c in '01']
+        rows = [bits[y*w:(y+1)*w] for y in range(h)]
+    else:
+        sys.exit('only P1 and P4 PBM files are supported')
+    return w, h, rows
+
+# native page format: w bytes for each 8 rows, bit 0 - top row
+def pages(w, h, rows):
+    out = []
+    for y8 in range((h+7)//8):
+        for x in range(w):
+            b = 0
+            for r in range(8):
+                y = y8*8+r
+                if y < h and rows[y][x]: b |= 1 << r
+            out.append(b)
+    return out
+
+# 0x00-0x7f: c+1 literal bytes, 0x80-0xbf: c-0x7f zero bytes, 0xc0-0xff: next byte repeated c-0xbf times
+def rle(data):
+    out, lit, i = [], [], 0
+    def flushLit():
+        while lit:
+            n = min(len(lit), 128)
+            out.append(n-1)
+            out.extend(lit[:n])
+            del lit[:n]
+    while i < len(data):
+        n = 1
+        while i+n < len(data) and n < 64 and data[i+n] == data[i]: n += 1
+        if data[i] == 0 and n >= 2:
+            flushLit()
+            out.append(0x7f+n)
+        elif n >= 3:
+            flushLit()
+            out.extend([0xbf+n, data[i]])
+        else:
+            lit.append(data[i])
+            n = 1
+        i += n
+    flushLit()
+    return out
+
+if len(sys.argv) < 2:
+    sys.exit('usage: pbm2rle.py image.pbm [name] > image.h')
+w, h, rows = readPBM(sys.argv[1])
+if w > 255 or h > 255:
+    sys.exit('max image size is 255x255')
+name = sys.argv[2] if len(sys.argv) > 2 else sys.argv[1].rsplit('/', 1)[-1].split('.')[0]
+raw = pages(w, h, rows)
+comp = rle(raw)
+print('// %dx%d, %d bytes, uncompressed %d bytes' % (w, h, len(comp)+2, len(raw)+2))
+print('const uint8_t %s[] PROGMEM = { %d,%d,' % (name, w, h))
+for i in range(0, len(comp), 16):
+    print('  ' + ''.join('0x%02x,' % b for b in comp[i:i+16]))
+print('};')
+sys.stderr.write('%s: %d -> %d bytes, ratio %.2f\n' % (name, len(raw)+2, len(comp)+2, (len(raw)+2)/(len(comp)+2)))